@@ -22,6 +22,8 @@
 #include <iostream>
 #include <ns3/ble-module.h>
 
+#include "du-wpan-multimodel.h"
+
 
 
 using namespace ns3;
@@ -216,7 +218,20 @@ main(int argc, char* argv[])
     // LogComponentEnable("BleNetDevice", LOG_ALL);
     PacketMetadata::Enable();
 
-    Ptr<MultiModelSpectrumChannel> channel = CreateObject<MultiModelSpectrumChannel>();
+    bool overlap = true;
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("overlap", "OverlapSpectrumChannel (cached band overlaps) instead of MultiModelSpectrumChannel", overlap);
+    cmd.Parse(argc, argv);
+
+    Ptr<SpectrumChannel> channel;
+    if(overlap)
+    {
+        channel = CreateObject<OverlapSpectrumChannel>();
+    }
+    else
+    {
+        channel = CreateObject<MultiModelSpectrumChannel>();
+    }
     Ptr<LogDistancePropagationLossModel> lossModel = CreateObject<LogDistancePropagationLossModel>();
     channel->AddPropagationLossModel(lossModel);
     Ptr<ConstantSpeedPropagationDelayModel> delayModel = CreateObject<ConstantSpeedPropagationDelayModel>();
@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Coexistence benchmark of OverlapSpectrumChannel (du-wpan-multimodel.h)
+ * against MultiModelSpectrumChannel.
+ *
+ *   ./ns3 run "coexistence-bench --lrwpan=200 --ble=40 --wifi=20 --transmissions=20000"
+ *
+ * Every device is a counting PHY at a random position on a square; random
+ * devices transmit on a random channel of their technology:
+ *   lrwpan   model of LrWpanSpectrumValueHelper, channels 11..26
+ *   ble      1 MHz bands over the 2.4 GHz ISM band, 2 MHz channels 0..39
+ *   wifi     78.125 kHz bands over 20 MHz + 2 x 2 MHz guard, one model per
+ *            channel 1, 6 and 11 (a Wi-Fi PHY changes model with its channel)
+ *
+ * Both channels see the same transmissions. "diff" is the largest relative
+ * deviation of the energy a receiver collected, "rx events" counts StartRx()
+ * calls: the difference are the all-zero signals that are no longer sent.
+ */
+
+#include <ns3/core-module.h>
+#include <ns3/lr-wpan-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/propagation-module.h>
+#include <ns3/spectrum-module.h>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "du-wpan-multimodel.h"
+
+using namespace ns3;
+
+// receiver that only adds up what reaches it
+class CountingPhy: public SpectrumPhy
+{
+    public:
+        CountingPhy(Ptr<const SpectrumModel> model, Ptr<MobilityModel> mobility)
+            : model(model),
+              mobility(mobility),
+              events(0),
+              energy(0)
+        {
+        }
+
+        void SetDevice(Ptr<NetDevice> d) override {}
+        Ptr<NetDevice> GetDevice() const override { return nullptr; }
+        void SetMobility(Ptr<MobilityModel> m) override { this->mobility = m; }
+        Ptr<MobilityModel> GetMobility() const override { return this->mobility; }
+        void SetChannel(Ptr<SpectrumChannel> c) override {}
+        Ptr<const SpectrumModel> GetRxSpectrumModel() const override { return this->model; }
+        Ptr<Object> GetAntenna() const override { return nullptr; }
+
+        void StartRx(Ptr<SpectrumSignalParameters> params) override
+        {
+            this->events++;
+            this->energy += Integral(*(params->psd)) * params->duration.GetSeconds();
+        }
+
+        uint64_t GetEvents() const
+        {
+            return this->events;
+        }
+
+        double GetEnergy() const
+        {
+            return this->energy;
+        }
+
+    private:
+        Ptr<const SpectrumModel> model;
+        Ptr<MobilityModel> mobility;
+        uint64_t events;
+        double energy; // J
+};
+
+Ptr<SpectrumModel>
+UniformModel(double startHz, double bandHz, uint32_t bands)
+{
+    std::vector<double> centers;
+    for(uint32_t i = 0; i < bands; i++)
+    {
+        centers.push_back(startHz + (i + 0.5) * bandHz);
+    }
+    return Create<SpectrumModel>(centers);
+}
+
+// `watts` spread evenly over [lowHz, highHz) of `model`
+Ptr<SpectrumValue>
+BandPsd(Ptr<const SpectrumModel> model, double lowHz, double highHz, double watts)
+{
+    Ptr<SpectrumValue> psd = Create<SpectrumValue>(model);
+    uint32_t i = 0;
+    for(Bands::const_iterator band = model->Begin(); band != model->End(); band++, i++)
+    {
+        double overlap = std::min(band->fh, highHz) - std::max(band->fl, lowHz);
+        if(overlap > 0)
+        {
+            (*psd)[i] = watts / (highHz - lowHz) * overlap / (band->fh - band->fl);
+        }
+    }
+    return psd;
+}
+
+struct Device
+{
+    std::string technology;
+    Ptr<const SpectrumModel> model;
+    Ptr<MobilityModel> mobility;
+    uint32_t wifiChannel;
+};
+
+struct Transmission
+{
+    uint32_t device;
+    Ptr<SpectrumValue> psd;
+    Time duration;
+};
+
+struct Result
+{
+    double seconds;
+    std::vector<double> energy;
+    uint64_t events;
+};
+
+Result
+Run(Ptr<SpectrumChannel> channel, const std::vector<Device>& devices, const std::vector<Transmission>& transmissions)
+{
+    channel->AddPropagationLossModel(CreateObject<LogDistancePropagationLossModel>());
+    channel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+
+    std::vector<Ptr<CountingPhy>> phys;
+    for(const Device& device : devices)
+    {
+        Ptr<CountingPhy> phy = CreateObject<CountingPhy>(device.model, device.mobility);
+        channel->AddRx(phy);
+        phys.push_back(phy);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < transmissions.size(); i++)
+    {
+        Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters>();
+        params->psd = transmissions[i].psd;
+        params->duration = transmissions[i].duration;
+        params->txPhy = phys[transmissions[i].device];
+        Simulator::Schedule(MicroSeconds(100) * (int64_t) i, &SpectrumChannel::StartTx, channel, params);
+    }
+    Simulator::Run();
+    auto stop = std::chrono::steady_clock::now();
+
+    Result result;
+    result.seconds = std::chrono::duration<double>(stop - start).count();
+    result.events = 0;
+    for(auto& phy : phys)
+    {
+        result.energy.push_back(phy->GetEnergy());
+        result.events += phy->GetEvents();
+    }
+    Simulator::Destroy();
+    return result;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t lrwpan = 200;
+    uint32_t ble = 40;
+    uint32_t wifi = 20;
+    uint32_t transmissions = 20000;
+    double side = 100; // m
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("lrwpan", "LR-WPAN devices", lrwpan);
+    cmd.AddValue("ble", "BLE devices", ble);
+    cmd.AddValue("wifi", "Wi-Fi devices, spread over channels 1, 6 and 11", wifi);
+    cmd.AddValue("transmissions", "transmissions by random devices", transmissions);
+    cmd.AddValue("side", "side of the square the devices are on (m)", side);
+    cmd.Parse(argc, argv);
+
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+
+    lrwpan::LrWpanSpectrumValueHelper lrwpanHelper;
+    Ptr<const SpectrumModel> lrwpanModel = lrwpanHelper.CreateTxPowerSpectralDensity(0, 11)->GetSpectrumModel();
+    Ptr<const SpectrumModel> bleModel = UniformModel(2400e6, 1e6, 84);
+    std::vector<Ptr<const SpectrumModel>> wifiModels;
+    const uint32_t wifiChannels[] = {1, 6, 11};
+    for(uint32_t channel : wifiChannels)
+    {
+        wifiModels.push_back(UniformModel((2407 + 5 * channel) * 1e6 - 12e6, 78125, 308));
+    }
+
+    std::vector<Device> devices;
+    auto add = [&](std::string technology, Ptr<const SpectrumModel> model, uint32_t wifiChannel) {
+        Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel>();
+        mobility->SetPosition(Vector(rng->GetValue(0, side), rng->GetValue(0, side), 1));
+        devices.push_back({technology, model, mobility, wifiChannel});
+    };
+    for(uint32_t i = 0; i < lrwpan; i++)
+    {
+        add("lrwpan", lrwpanModel, 0);
+    }
+    for(uint32_t i = 0; i < ble; i++)
+    {
+        add("ble", bleModel, 0);
+    }
+    for(uint32_t i = 0; i < wifi; i++)
+    {
+        add("wifi", wifiModels[i % 3], wifiChannels[i % 3]);
+    }
+    NS_ABORT_MSG_IF(devices.empty(), "no devices");
+
+    // 0 dBm LR-WPAN and BLE, 20 dBm Wi-Fi
+    std::vector<Transmission> schedule;
+    for(uint32_t i = 0; i < transmissions; i++)
+    {
+        uint32_t d = rng->GetInteger(0, devices.size() - 1);
+        const Device& device = devices[d];
+        Transmission transmission;
+        transmission.device = d;
+        if(device.technology == "lrwpan")
+        {
+            transmission.psd = lrwpanHelper.CreateTxPowerSpectralDensity(0, rng->GetInteger(11, 26));
+            transmission.duration = MicroSeconds(4256); // 133 bytes
+        }
+        else if(device.technology == "ble")
+        {
+            double center = 2402e6 + 2e6 * rng->GetInteger(0, 39);
+            transmission.psd = BandPsd(device.model, center - 1e6, center + 1e6, 1e-3);
+            transmission.duration = MicroSeconds(376); // 47 bytes at 1 Mbps
+        }
+        else
+        {
+            double center = (2407 + 5 * device.wifiChannel) * 1e6;
+            transmission.psd = BandPsd(device.model, center - 10e6, center + 10e6, 0.1);
+            transmission.duration = MicroSeconds(200);
+        }
+        schedule.push_back(transmission);
+    }
+
+    Result reference = Run(CreateObject<MultiModelSpectrumChannel>(), devices, schedule);
+    Ptr<OverlapSpectrumChannel> overlapChannel = CreateObject<OverlapSpectrumChannel>();
+    Result overlap = Run(overlapChannel, devices, schedule);
+
+    double diff = 0;
+    for(uint32_t i = 0; i < devices.size(); i++)
+    {
+        if(reference.energy[i] > 0)
+        {
+            diff = std::max(diff, std::abs(overlap.energy[i] - reference.energy[i]) / reference.energy[i]);
+        }
+        else if(overlap.energy[i] > 0)
+        {
+            diff = std::max(diff, 1.0);
+        }
+    }
+
+    std::cout << "devices: " << devices.size() << " (lrwpan " << lrwpan << ", ble " << ble << ", wifi " << wifi
+              << "), transmissions: " << transmissions << "\n"
+              << std::setw(12) << "channel" << std::setw(14) << "us/tx" << std::setw(14) << "rx events" << std::setw(10)
+              << "speedup" << "\n";
+    auto row = [&](std::string name, const Result& result) {
+        std::cout << std::setw(12) << name << std::setw(14) << std::fixed << std::setprecision(2)
+                  << result.seconds * 1e6 / transmissions << std::setw(14) << result.events << std::setw(9)
+                  << reference.seconds / result.seconds << "x" << std::defaultfloat << "\n";
+    };
+    row("multimodel", reference);
+    row("overlap", overlap);
+    std::cout << "receivers skipped (no band overlap): " << overlapChannel->GetSkippedReceiverCount()
+              << ", conversions: " << overlapChannel->GetConversionCount()
+              << ", diff: " << std::scientific << std::setprecision(2) << diff << "\n";
+
+    return 0;
+}
@@ -0,0 +1,984 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Abstracted link-level LR-WPAN PHY/MAC for large du-wpan runs.
+ *
+ * Only frame-level events are simulated. Nothing is built per band, and no
+ * packet is copied per receiver:
+ *
+ *   link budget    sparse table of rx power per device pair, built once from
+ *                  the propagation loss model through a uniform grid, links
+ *                  below InterferenceCutoff are dropped; a device that moves
+ *                  only has its own links recomputed (MoveDevice())
+ *   medium         every frame on air adds its rx power to the interference
+ *                  accumulator (du-wpan-interference.h) of each linked device
+ *   reception      an idle listening device locks onto a frame at or above
+ *                  RxSensitivity, like LrWpanPhy; the SINR chunks of the frame
+ *                  go through the error table (du-wpan-error-table.h) and the
+ *                  outcome is one Bernoulli draw
+ *   MAC            unslotted CSMA-CA (backoff, 8 symbol CCA at CcaThreshold,
+ *                  turnaround), ACK with macAckWaitDuration and frame
+ *                  retries, IFS after every transaction
+ *
+ * Propagation delay is not modelled (under 1 us in a du-wpan cell). The
+ * devices report the same MCPS-DATA.confirm/indication and PhyTxBegin /
+ * PhyRxBegin events as LrWpanNetDevice, so PANNetwork statistics are shared
+ * by both modes.
+ *
+ * Frame boundaries: a frame is known one turnaround before it goes on air
+ * (Commit()). Starts and ends of frames are scheduled a window of one
+ * turnaround ahead (Window()), sorted by time, ends first, then by source,
+ * so frames that start or end at the same time are handled in the same order
+ * whichever events were scheduled around them.
+ *
+ * Regions: in a partitioned run (du-wpan-distributed.h) every process keeps
+ * all devices but only simulates those of its own region. Committed frames
+ * are exchanged with the regions that hear them at every window, before any
+ * of them starts. Every device draws from its own random stream, so a
+ * partitioned run repeats the draws and the event order of a single process.
+ */
+
+#ifndef DU_WPAN_ABSTRACT_H
+#define DU_WPAN_ABSTRACT_H
+
+#include <ns3/core-module.h>
+#include <ns3/lr-wpan-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/network-module.h>
+#include <ns3/propagation-module.h>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+#include "du-wpan-distributed.h"
+#include "du-wpan-energy.h"
+#include "du-wpan-error-table.h"
+#include "du-wpan-grid.h"
+#include "du-wpan-interference.h"
+
+// O-QPSK 2.4 GHz, one symbol is 16 us
+#define LRWPAN_UNIT_BACKOFF 320 // us, aUnitBackoffPeriod
+#define LRWPAN_CCA_DURATION 128 // us, 8 symbols
+#define LRWPAN_TURNAROUND 192   // us, aTurnaroundTime
+#define LRWPAN_ACK_WAIT 864     // us, macAckWaitDuration
+#define LRWPAN_SIFS 192         // us, macSIFSPeriod
+#define LRWPAN_LIFS 640         // us, macLIFSPeriod
+#define LRWPAN_MAX_SIFS_FRAME 18 // bytes, aMaxSIFSFrameSize
+#define LRWPAN_BIT_DURATION 4    // us, 250 kbps
+#define LRWPAN_SHR_PHR 6         // bytes, preamble, SFD and PHR
+#define LRWPAN_DATA_OVERHEAD 23  // bytes, MHR with extended addresses and PAN ID compression, FCS
+#define LRWPAN_ACK_SIZE 5        // bytes, PSDU of an ACK
+
+namespace ns3
+{
+
+class AbstractLrWpanMedium: public Object
+{
+    public:
+        static TypeId GetTypeId(void) {
+            static TypeId tid = TypeId("AbstractLrWpanMedium")
+                .SetParent<Object>()
+                .SetGroupName("LrWpan")
+                .AddConstructor<AbstractLrWpanMedium>()
+                .AddAttribute("TxPower",
+                              "Transmit power of every device (dBm)",
+                              DoubleValue(0),
+                              MakeDoubleAccessor(&AbstractLrWpanMedium::txPowerDbm),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("RxSensitivity",
+                              "Weakest frame a receiver locks onto (dBm), LrWpanPhy default",
+                              DoubleValue(-106.58),
+                              MakeDoubleAccessor(&AbstractLrWpanMedium::sensitivityDbm),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("CcaThreshold",
+                              "Energy that makes the CCA report a busy channel (dBm), 10 dB above the sensitivity",
+                              DoubleValue(-96.58),
+                              MakeDoubleAccessor(&AbstractLrWpanMedium::ccaThresholdDbm),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("NoisePower",
+                              "Noise in the channel (dBm), kT over the 3 MHz of TotalAvgPower()",
+                              DoubleValue(-109.2),
+                              MakeDoubleAccessor(&AbstractLrWpanMedium::noiseDbm),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("InterferenceCutoff",
+                              "Links weaker than this are left out of the link budget table (dBm)",
+                              DoubleValue(-119.2),
+                              MakeDoubleAccessor(&AbstractLrWpanMedium::cutoffDbm),
+                              MakeDoubleChecker<double>());
+            return tid;
+        }
+
+        AbstractLrWpanMedium()
+            : txPowerDbm(0),
+              sensitivityDbm(-106.58),
+              ccaThresholdDbm(-96.58),
+              noiseDbm(-109.2),
+              cutoffDbm(-119.2),
+              minBE(3),
+              maxBE(5),
+              maxCsmaBackoffs(4),
+              maxFrameRetries(3),
+              range(0),
+              linkCount(0),
+              linkUpdates(0),
+              nextFrameId(1),
+              localRegion(0)
+        {
+            this->errorTable = CreateObject<LrWpanChunkSuccessTable>();
+        }
+
+        void SetPropagationLossModel(Ptr<PropagationLossModel> model)
+        {
+            this->lossModel = model;
+        }
+
+        void SetCsmaParameters(uint32_t minBE, uint32_t maxBE, uint32_t maxCsmaBackoffs)
+        {
+            this->minBE = minBE;
+            this->maxBE = maxBE;
+            this->maxCsmaBackoffs = maxCsmaBackoffs;
+        }
+
+        void SetMaxFrameRetries(uint32_t retries)
+        {
+            this->maxFrameRetries = retries;
+        }
+
+        void SetExactErrorModel(bool exact)
+        {
+            this->errorTable->SetExact(exact);
+        }
+
+        int64_t AssignStreams(int64_t stream)
+        {
+            for(uint32_t i = 0; i < this->devices.size(); i++)
+            {
+                this->devices[i].rng->SetStream(stream + i);
+            }
+            return this->devices.size();
+        }
+
+        // returns the index of the device in this medium
+        uint32_t AddDevice(Vector position, bool rxOnWhenIdle)
+        {
+            Device device;
+            device.position = position;
+            device.rxOnWhenIdle = rxOnWhenIdle;
+            device.interference = Create<InterferenceAccumulator>(DbmToW(this->noiseDbm));
+            device.rng = CreateObject<UniformRandomVariable>();
+            this->devices.push_back(device);
+            return this->devices.size() - 1;
+        }
+
+        uint32_t GetDeviceCount() const
+        {
+            return this->devices.size();
+        }
+
+        uint64_t GetLinkCount() const
+        {
+            return this->linkCount;
+        }
+
+        uint64_t GetLinkUpdateCount() const // links recomputed by MoveDevice()
+        {
+            return this->linkUpdates;
+        }
+
+        double GetInterferenceRange() const // m
+        {
+            return this->range;
+        }
+
+        // range for loss models that do not grow with distance alone, 0: found by Build()
+        void SetInterferenceRange(double range)
+        {
+            this->range = range;
+        }
+
+        // partitioned run: region of a device, before Build()
+        void SetRegion(uint32_t index, uint32_t region)
+        {
+            this->devices[index].region = region;
+        }
+
+        // partitioned run: only devices of the region of `exchange` are simulated here
+        void SetRegionExchange(Ptr<RegionExchange> exchange)
+        {
+            this->exchange = exchange;
+            this->localRegion = exchange->GetRegion();
+            this->outbox.assign(exchange->GetRegionCount(), std::vector<Commitment>());
+        }
+
+        bool IsLocal(uint32_t index) const
+        {
+            return this->devices[index].region == this->localRegion;
+        }
+
+        // a frame is committed this long before it goes on air, length of a window
+        static Time GetLookahead()
+        {
+            return MicroSeconds(LRWPAN_TURNAROUND);
+        }
+
+        // first window, after Build()
+        void Start()
+        {
+            Simulator::Schedule(Time(0), &AbstractLrWpanMedium::Window, this);
+        }
+
+        void SetRxOnWhenIdle(uint32_t index, bool on)
+        {
+            this->devices[index].rxOnWhenIdle = on;
+            this->UpdateRadio(index);
+        }
+
+        void SetEnergyModel(uint32_t index, Ptr<LrWpanRadioEnergyModel> model)
+        {
+            this->devices[index].energy = model;
+            this->UpdateRadio(index);
+        }
+
+        void SetMcpsDataConfirmCallback(uint32_t index, lrwpan::McpsDataConfirmCallback callback)
+        {
+            this->devices[index].confirm = callback;
+        }
+
+        void SetMcpsDataIndicationCallback(uint32_t index, lrwpan::McpsDataIndicationCallback callback)
+        {
+            this->devices[index].indication = callback;
+        }
+
+        void SetPhyTxBeginCallback(uint32_t index, Callback<void, Ptr<const Packet>> callback)
+        {
+            this->devices[index].txBegin = callback;
+        }
+
+        void SetPhyRxBeginCallback(uint32_t index, Callback<void, Ptr<const Packet>> callback)
+        {
+            this->devices[index].rxBegin = callback;
+        }
+
+        /*
+         * Link budget table, after every device is added. Devices are hashed
+         * into square cells of the interference range, so only the 3x3 cells
+         * around a device are evaluated with the loss model. Only links to
+         * local receivers are kept; a local device remembers the other regions
+         * it reaches.
+         */
+        void Build()
+        {
+            NS_ABORT_MSG_IF(!this->lossModel, "no propagation loss model");
+
+            if(this->range <= 0)
+            {
+                this->range = this->FindRange();
+            }
+            this->grid.Reset(this->range);
+            for(uint32_t i = 0; i < this->devices.size(); i++)
+            {
+                this->grid.Insert(i, this->devices[i].position);
+            }
+
+            Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel>();
+            Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel>();
+            this->linkCount = 0;
+            for(uint32_t i = 0; i < this->devices.size(); i++)
+            {
+                Device& device = this->devices[i];
+                device.links.clear();
+                device.remoteRegions.clear();
+                a->SetPosition(device.position);
+                bool local = this->IsLocal(i);
+
+                this->grid.ForEachNear(device.position, [&](uint32_t j) {
+                    uint32_t region = this->devices[j].region;
+                    if(j == i || (!local && region != this->localRegion))
+                    {
+                        return;
+                    }
+                    b->SetPosition(this->devices[j].position);
+                    double rxDbm = this->lossModel->CalcRxPower(this->txPowerDbm, a, b);
+                    if(rxDbm < this->cutoffDbm)
+                    {
+                        return;
+                    }
+                    if(region != this->localRegion)
+                    {
+                        auto it = std::lower_bound(device.remoteRegions.begin(), device.remoteRegions.end(), region);
+                        if(it == device.remoteRegions.end() || *it != region)
+                        {
+                            device.remoteRegions.insert(it, region);
+                        }
+                        return;
+                    }
+                    device.links.push_back({j, (float) DbmToW(rxDbm)});
+                });
+                // receivers in index order, independent of the hash map layout
+                std::sort(device.links.begin(), device.links.end(), [](const Link& x, const Link& y) { return x.device < y.device; });
+                this->linkCount += device.links.size();
+            }
+        }
+
+        /*
+         * New position of a device after Build(). Only the links from and to
+         * this device change: the old ones are dropped from the devices near
+         * the old position, the new ones computed against the devices near the
+         * new position. Frames already on air keep their power. Single region
+         * only.
+         */
+        void MoveDevice(uint32_t index, Vector position)
+        {
+            Device& device = this->devices[index];
+            this->grid.ForEachNear(device.position, [&](uint32_t j) {
+                if(j != index && EraseLink(this->devices[j].links, index))
+                {
+                    this->linkCount--;
+                }
+            });
+            this->linkCount -= device.links.size();
+            device.links.clear();
+
+            this->grid.Move(index, device.position, position);
+            device.position = position;
+
+            Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel>();
+            Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel>();
+            a->SetPosition(position);
+            this->grid.ForEachNear(position, [&](uint32_t j) {
+                if(j == index)
+                {
+                    return;
+                }
+                b->SetPosition(this->devices[j].position);
+                double outDbm = this->lossModel->CalcRxPower(this->txPowerDbm, a, b);
+                double inDbm = this->lossModel->CalcRxPower(this->txPowerDbm, b, a);
+                if(outDbm >= this->cutoffDbm)
+                {
+                    device.links.push_back({j, (float) DbmToW(outDbm)});
+                }
+                if(inDbm >= this->cutoffDbm)
+                {
+                    std::vector<Link>& links = this->devices[j].links;
+                    links.insert(LowerBound(links, index), {index, (float) DbmToW(inDbm)});
+                    this->linkCount++;
+                }
+                this->linkUpdates += 2;
+            });
+            std::sort(device.links.begin(), device.links.end(), [](const Link& x, const Link& y) { return x.device < y.device; });
+            this->linkCount += device.links.size();
+        }
+
+        // MCPS-DATA.request of an end device, one at a time per device
+        void McpsDataRequest(uint32_t src, uint32_t dst, Ptr<Packet> msdu, bool ack)
+        {
+            Device& device = this->devices[src];
+            NS_ASSERT_MSG(!device.msdu, "transaction in progress");
+
+            device.msdu = msdu;
+            device.dst = dst;
+            device.ackRequested = ack;
+            device.retries = 0;
+            device.seq++;
+
+            Time wait = Max(device.ifsEnd - Simulator::Now(), Time(0));
+            Simulator::Schedule(wait, &AbstractLrWpanMedium::StartCsma, this, src);
+        }
+
+
+    protected:
+        void DoDispose() override
+        {
+            this->devices.clear();
+            this->frames.clear();
+            this->starts.clear();
+            this->ends.clear();
+            this->lossModel = nullptr;
+            this->exchange = nullptr;
+            this->errorTable = nullptr;
+            Object::DoDispose();
+        }
+
+    private:
+        enum PhyState
+        {
+            PHY_IDLE, // listening or off, see Listening()
+            PHY_RX,   // locked onto a frame
+            PHY_TX    // turnaround or transmitting
+        };
+
+        struct Link
+        {
+            uint32_t device;
+            float power; // W at the receiver
+        };
+
+        struct Device
+        {
+            Vector position;
+            std::vector<Link> links; // local devices that hear this one
+            std::vector<uint32_t> remoteRegions; // other regions that hear this one, sorted
+            uint32_t region = 0;
+            Ptr<InterferenceAccumulator> interference;
+            Ptr<UniformRandomVariable> rng;
+
+            PhyState state = PHY_IDLE;
+            bool rxOnWhenIdle = true;
+            bool cca = false;
+            bool ccaBusy = false;
+            bool ackWait = false;
+            uint64_t rxFrame = 0;
+            InterferenceAccumulator::SignalId rxSignal = 0;
+
+            // transaction in the MAC
+            Ptr<Packet> msdu;
+            uint32_t dst = 0;
+            bool ackRequested = false;
+            uint32_t nb = 0;
+            uint32_t be = 0;
+            uint32_t retries = 0;
+            uint8_t seq = 0;
+            EventId ackTimeout;
+            uint32_t ackTo = 0; // ACK to send after a turnaround
+            uint8_t ackSeq = 0;
+            Time ifsEnd;
+
+            lrwpan::McpsDataConfirmCallback confirm;
+            lrwpan::McpsDataIndicationCallback indication;
+            Callback<void, Ptr<const Packet>> txBegin;
+            Callback<void, Ptr<const Packet>> rxBegin;
+            Ptr<LrWpanRadioEnergyModel> energy;
+        };
+
+        // frame known at the start of the turnaround, sent between regions as bytes
+        struct Commitment
+        {
+            int64_t start; // ns
+            uint32_t src;
+            uint32_t dst;
+            uint32_t psduSize;
+            uint8_t seq;
+            bool isAck;
+            bool ackRequested;
+        };
+
+        struct FrameEnd
+        {
+            Time time;
+            uint32_t src;
+            uint64_t frameId;
+        };
+
+        struct Frame
+        {
+            uint32_t src;
+            uint32_t dst;
+            bool isAck;
+            bool ackRequested;
+            uint8_t seq;
+            Ptr<Packet> msdu;
+            Time start;
+            bool remote; // sent in another region
+            std::vector<std::pair<uint32_t, InterferenceAccumulator::SignalId>> signals; // per linked device
+        };
+
+        static double DbmToW(double dbm)
+        {
+            return std::pow(10.0, (dbm - 30) / 10.0);
+        }
+
+        static Time FrameDuration(uint32_t psduSize)
+        {
+            return MicroSeconds((LRWPAN_SHR_PHR + psduSize) * 8 * LRWPAN_BIT_DURATION);
+        }
+
+        static std::vector<Link>::iterator LowerBound(std::vector<Link>& links, uint32_t device)
+        {
+            return std::lower_bound(links.begin(), links.end(), device, [](const Link& link, uint32_t d) { return link.device < d; });
+        }
+
+        static bool EraseLink(std::vector<Link>& links, uint32_t device)
+        {
+            auto it = LowerBound(links, device);
+            if(it == links.end() || it->device != device)
+            {
+                return false;
+            }
+            links.erase(it);
+            return true;
+        }
+
+        // distance at which the rx power falls below the cutoff, loss assumed to grow with distance
+        double FindRange()
+        {
+            Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel>();
+            Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel>();
+            auto above = [&](double d) {
+                b->SetPosition(Vector(d, 0, 0));
+                return this->lossModel->CalcRxPower(this->txPowerDbm, a, b) >= this->cutoffDbm;
+            };
+
+            double high = 1;
+            while(above(high) && high < 1e6)
+            {
+                high *= 2;
+            }
+            double low = high / 2;
+            for(int i = 0; i < 40; i++)
+            {
+                double mid = 0.5 * (low + high);
+                (above(mid) ? low : high) = mid;
+            }
+            return high;
+        }
+
+        bool Listening(const Device& device) const
+        {
+            return device.rxOnWhenIdle || device.ackWait || device.cca;
+        }
+
+        void UpdateRadio(uint32_t index)
+        {
+            Device& device = this->devices[index];
+            if(!device.energy)
+            {
+                return;
+            }
+            switch(device.state)
+            {
+                case PHY_TX:
+                    device.energy->ChangeState(LrWpanRadioEnergyModel::RADIO_TX);
+                    break;
+                case PHY_RX:
+                    device.energy->ChangeState(LrWpanRadioEnergyModel::RADIO_RX);
+                    break;
+                default:
+                    device.energy->ChangeState(this->Listening(device) ? LrWpanRadioEnergyModel::RADIO_IDLE : LrWpanRadioEnergyModel::RADIO_SLEEP);
+                    break;
+            }
+        }
+
+        // CSMA-CA, unslotted
+        void StartCsma(uint32_t index)
+        {
+            Device& device = this->devices[index];
+            device.nb = 0;
+            device.be = this->minBE;
+            this->Backoff(index);
+        }
+
+        void Backoff(uint32_t index)
+        {
+            Device& device = this->devices[index];
+            uint32_t periods = device.rng->GetInteger(0, (1u << device.be) - 1);
+            Simulator::Schedule(MicroSeconds(periods * LRWPAN_UNIT_BACKOFF), &AbstractLrWpanMedium::StartCca, this, index);
+        }
+
+        void StartCca(uint32_t index)
+        {
+            Device& device = this->devices[index];
+            device.cca = true;
+            device.ccaBusy = device.state == PHY_RX || this->CcaEnergyBusy(device);
+            this->UpdateRadio(index);
+            Simulator::Schedule(MicroSeconds(LRWPAN_CCA_DURATION), &AbstractLrWpanMedium::EndCca, this, index);
+        }
+
+        bool CcaEnergyBusy(const Device& device) const
+        {
+            return device.interference->GetTotal() >= DbmToW(this->ccaThresholdDbm);
+        }
+
+        void EndCca(uint32_t index)
+        {
+            Device& device = this->devices[index];
+            device.cca = false;
+            this->UpdateRadio(index);
+
+            if(!device.ccaBusy)
+            {
+                this->StartTurnaround(index);
+                this->Commit(index, false);
+                return;
+            }
+
+            device.nb++;
+            device.be = std::min(device.be + 1, this->maxBE);
+            if(device.nb > this->maxCsmaBackoffs)
+            {
+                this->Finish(index, lrwpan::MacStatus::CHANNEL_ACCESS_FAILURE);
+                return;
+            }
+            this->Backoff(index);
+        }
+
+        // receiver off, a frame being received is lost
+        void StartTurnaround(uint32_t index)
+        {
+            Device& device = this->devices[index];
+            if(device.state == PHY_RX)
+            {
+                device.interference->EndReception(device.rxSignal);
+            }
+            device.state = PHY_TX;
+            this->UpdateRadio(index);
+        }
+
+        // the frame `index` sends after the turnaround, here and in the regions that hear it
+        void Commit(uint32_t index, bool isAck)
+        {
+            Device& device = this->devices[index];
+            Commitment frame;
+            frame.start = (Simulator::Now() + MicroSeconds(LRWPAN_TURNAROUND)).GetNanoSeconds();
+            frame.src = index;
+            frame.isAck = isAck;
+            frame.dst = isAck ? device.ackTo : device.dst;
+            frame.ackRequested = !isAck && device.ackRequested;
+            frame.seq = isAck ? device.ackSeq : device.seq;
+            frame.psduSize = isAck ? LRWPAN_ACK_SIZE : LRWPAN_DATA_OVERHEAD + device.msdu->GetSize();
+            this->starts.push_back(frame);
+            for(uint32_t region : device.remoteRegions)
+            {
+                this->outbox[region].push_back(frame);
+            }
+        }
+
+        /*
+         * Frame boundaries up to the end of the next window, in an order that
+         * does not depend on where the frames were committed. Every frame that
+         * starts in the next window has been committed (and exchanged) by now.
+         */
+        void Window()
+        {
+            Time end = Simulator::Now() + GetLookahead();
+            if(this->exchange && this->exchange->GetRegionCount() > 1)
+            {
+                std::vector<std::vector<Commitment>> outbox(this->outbox.size());
+                this->outbox.swap(outbox);
+                std::vector<Commitment> received = this->exchange->Exchange(outbox);
+                this->starts.insert(this->starts.end(), received.begin(), received.end());
+            }
+
+            struct Boundary
+            {
+                Time time;
+                bool start;
+                uint32_t src;
+                size_t item;
+            };
+            std::vector<Boundary> boundaries;
+            for(size_t i = 0; i < this->ends.size(); i++)
+            {
+                if(this->ends[i].time <= end)
+                {
+                    boundaries.push_back({this->ends[i].time, false, this->ends[i].src, i});
+                }
+            }
+            for(size_t i = 0; i < this->starts.size(); i++)
+            {
+                if(NanoSeconds(this->starts[i].start) <= end)
+                {
+                    boundaries.push_back({NanoSeconds(this->starts[i].start), true, this->starts[i].src, i});
+                }
+            }
+            std::sort(boundaries.begin(), boundaries.end(), [](const Boundary& a, const Boundary& b) {
+                if(a.time != b.time)
+                {
+                    return a.time < b.time;
+                }
+                return a.start != b.start ? b.start : a.src < b.src;
+            });
+
+            Time now = Simulator::Now();
+            for(const Boundary& boundary : boundaries)
+            {
+                if(boundary.start)
+                {
+                    Simulator::Schedule(boundary.time - now, &AbstractLrWpanMedium::StartFrame, this, this->starts[boundary.item]);
+                }
+                else
+                {
+                    Simulator::Schedule(boundary.time - now, &AbstractLrWpanMedium::EndTx, this, this->ends[boundary.item].frameId);
+                }
+            }
+            this->ends.erase(std::remove_if(this->ends.begin(), this->ends.end(), [end](const FrameEnd& e) { return e.time <= end; }),
+                             this->ends.end());
+            this->starts.erase(std::remove_if(this->starts.begin(), this->starts.end(), [end](const Commitment& c) { return NanoSeconds(c.start) <= end; }),
+                               this->starts.end());
+
+            Simulator::Schedule(GetLookahead(), &AbstractLrWpanMedium::Window, this);
+        }
+
+        void StartFrame(Commitment frame)
+        {
+            if(this->IsLocal(frame.src))
+            {
+                this->StartTx(frame.src, frame.isAck);
+                return;
+            }
+            this->StartRemoteTx(frame);
+        }
+
+        // frame of a device of another region, radiated to the devices of this one
+        void StartRemoteTx(const Commitment& remote)
+        {
+            Frame frame;
+            frame.src = remote.src;
+            frame.dst = remote.dst;
+            frame.isAck = remote.isAck;
+            frame.ackRequested = remote.ackRequested;
+            frame.seq = remote.seq;
+            if(!remote.isAck)
+            {
+                frame.msdu = Create<Packet>(remote.psduSize - LRWPAN_DATA_OVERHEAD);
+            }
+            frame.start = Simulator::Now();
+            frame.remote = true;
+            this->Radiate(std::move(frame), remote.psduSize);
+        }
+
+        void StartTx(uint32_t index, bool isAck)
+        {
+            Device& device = this->devices[index];
+
+            Frame frame;
+            frame.src = index;
+            frame.isAck = isAck;
+            frame.start = Simulator::Now();
+            frame.remote = false;
+            uint32_t psduSize;
+            if(isAck)
+            {
+                frame.dst = device.ackTo;
+                frame.ackRequested = false;
+                frame.seq = device.ackSeq;
+                psduSize = LRWPAN_ACK_SIZE;
+            }
+            else
+            {
+                frame.dst = device.dst;
+                frame.ackRequested = device.ackRequested;
+                frame.seq = device.seq;
+                frame.msdu = device.msdu;
+                psduSize = LRWPAN_DATA_OVERHEAD + device.msdu->GetSize();
+            }
+
+            if(!device.txBegin.IsNull())
+            {
+                device.txBegin(Create<Packet>(psduSize));
+            }
+            this->Radiate(std::move(frame), psduSize);
+        }
+
+        // frame on air at every local device linked to its source
+        void Radiate(Frame frame, uint32_t psduSize)
+        {
+            const Device& device = this->devices[frame.src];
+            uint64_t frameId = this->nextFrameId++;
+            double sensitivity = DbmToW(this->sensitivityDbm);
+            double ccaThreshold = DbmToW(this->ccaThresholdDbm);
+            frame.signals.reserve(device.links.size());
+            for(const Link& link : device.links)
+            {
+                Device& receiver = this->devices[link.device];
+                InterferenceAccumulator::SignalId signal = receiver.interference->Add(link.power);
+                frame.signals.push_back({link.device, signal});
+
+                if(receiver.cca && receiver.interference->GetTotal() >= ccaThreshold)
+                {
+                    receiver.ccaBusy = true;
+                }
+                if(receiver.state == PHY_IDLE && this->Listening(receiver) && link.power >= sensitivity)
+                {
+                    receiver.state = PHY_RX;
+                    receiver.rxFrame = frameId;
+                    receiver.rxSignal = signal;
+                    receiver.interference->StartReception(signal);
+                    this->UpdateRadio(link.device);
+                    if(!receiver.rxBegin.IsNull())
+                    {
+                        receiver.rxBegin(Create<Packet>(psduSize));
+                    }
+                }
+            }
+
+            this->ends.push_back({Simulator::Now() + FrameDuration(psduSize), frame.src, frameId});
+            this->frames.emplace(frameId, std::move(frame));
+        }
+
+        void EndTx(uint64_t frameId)
+        {
+            auto it = this->frames.find(frameId);
+            Frame frame = std::move(it->second);
+            this->frames.erase(it);
+
+            // receptions end before the signal leaves the accumulators
+            for(auto& signal : frame.signals)
+            {
+                Device& receiver = this->devices[signal.first];
+                if(receiver.state == PHY_RX && receiver.rxFrame == frameId)
+                {
+                    bool success = this->Decode(receiver, signal.second);
+                    receiver.state = PHY_IDLE;
+                    receiver.interference->Remove(signal.second);
+                    this->UpdateRadio(signal.first);
+                    if(success && frame.dst == signal.first)
+                    {
+                        this->Receive(signal.first, frame);
+                    }
+                    continue;
+                }
+                receiver.interference->Remove(signal.second);
+            }
+            if(frame.remote)
+            {
+                return; // the source is simulated by its own region
+            }
+
+            Device& device = this->devices[frame.src];
+            device.state = PHY_IDLE;
+            if(frame.isAck)
+            {
+                this->UpdateRadio(frame.src);
+                return;
+            }
+            if(frame.ackRequested)
+            {
+                device.ackWait = true;
+                device.ackTimeout = Simulator::Schedule(MicroSeconds(LRWPAN_ACK_WAIT), &AbstractLrWpanMedium::AckTimeout, this, frame.src);
+                this->UpdateRadio(frame.src);
+                return;
+            }
+            this->UpdateRadio(frame.src);
+            this->Finish(frame.src, lrwpan::MacStatus::SUCCESS);
+        }
+
+        bool Decode(Device& receiver, InterferenceAccumulator::SignalId signal)
+        {
+            double logSuccess = 0;
+            for(auto& chunk : receiver.interference->EndReception(signal))
+            {
+                uint32_t bits = (uint32_t) std::llround(chunk.duration.GetNanoSeconds() / (LRWPAN_BIT_DURATION * 1000.0));
+                logSuccess += this->errorTable->GetLogChunkSuccessRate(chunk.sinr, bits);
+            }
+            return receiver.rng->GetValue() < std::exp(logSuccess);
+        }
+
+        // frame addressed to `index` received without error
+        void Receive(uint32_t index, const Frame& frame)
+        {
+            Device& device = this->devices[index];
+            if(frame.isAck)
+            {
+                if(device.ackWait && frame.seq == device.seq && frame.src == device.dst)
+                {
+                    device.ackTimeout.Cancel();
+                    device.ackWait = false;
+                    this->UpdateRadio(index);
+                    this->Finish(index, lrwpan::MacStatus::SUCCESS);
+                }
+                return;
+            }
+
+            if(frame.ackRequested)
+            {
+                device.ackTo = frame.src;
+                device.ackSeq = frame.seq;
+                this->StartTurnaround(index);
+                this->Commit(index, true);
+            }
+
+            if(!device.indication.IsNull())
+            {
+                lrwpan::McpsDataIndicationParams params;
+                params.m_srcAddrMode = lrwpan::EXT_ADDR;
+                params.m_dstAddrMode = lrwpan::EXT_ADDR;
+                params.m_dsn = frame.seq;
+                device.indication(params, frame.msdu->Copy());
+            }
+        }
+
+        void AckTimeout(uint32_t index)
+        {
+            Device& device = this->devices[index];
+            device.ackWait = false;
+            this->UpdateRadio(index);
+
+            if(device.retries < this->maxFrameRetries)
+            {
+                device.retries++;
+                this->StartCsma(index);
+                return;
+            }
+            this->Finish(index, lrwpan::MacStatus::NO_ACK);
+        }
+
+        // end of the transaction, IFS before the next one
+        void Finish(uint32_t index, lrwpan::MacStatus status)
+        {
+            Device& device = this->devices[index];
+            uint32_t psduSize = LRWPAN_DATA_OVERHEAD + device.msdu->GetSize();
+            device.ifsEnd = Simulator::Now() + MicroSeconds(psduSize > LRWPAN_MAX_SIFS_FRAME ? LRWPAN_LIFS : LRWPAN_SIFS);
+            device.msdu = nullptr;
+
+            if(!device.confirm.IsNull())
+            {
+                lrwpan::McpsDataConfirmParams params;
+                params.m_msduHandle = 0;
+                params.m_status = status;
+                device.confirm(params);
+            }
+        }
+
+        double txPowerDbm;
+        double sensitivityDbm;
+        double ccaThresholdDbm;
+        double noiseDbm;
+        double cutoffDbm;
+
+        uint32_t minBE;
+        uint32_t maxBE;
+        uint32_t maxCsmaBackoffs;
+        uint32_t maxFrameRetries;
+
+        Ptr<PropagationLossModel> lossModel;
+        Ptr<LrWpanChunkSuccessTable> errorTable;
+
+        std::vector<Device> devices;
+        double range; // m, interference range and grid cell size
+        SpatialGrid grid;
+        uint64_t linkCount;
+        uint64_t linkUpdates;
+
+        std::unordered_map<uint64_t, Frame> frames; // on air
+        uint64_t nextFrameId;
+
+        std::vector<Commitment> starts; // committed, not scheduled yet
+        std::vector<FrameEnd> ends;     // on air, end not scheduled yet
+
+        Ptr<RegionExchange> exchange;
+        uint32_t localRegion;
+        std::vector<std::vector<Commitment>> outbox; // committed frames for the other regions
+};
+
+} // namespace ns3
+
+#endif /* DU_WPAN_ABSTRACT_H */
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Several sensor readings in the MSDU of one data frame.
+ *
+ *   +-------+--------+--------+-----+-----------+-----------+-----+
+ *   | count | len[0] | len[1] | ... | reading 0 | reading 1 | ... |
+ *   +-------+--------+--------+-----+-----------+-----------+-----+
+ *     1 B     1 B each                len[i] B each
+ *
+ * The end device packs what its queue holds, the coordinator unpacks it in the
+ * MCPS-DATA.indication; MAC header, FCS, CSMA-CA and ACK are paid once per frame.
+ */
+
+#ifndef DU_WPAN_AGGREGATE_H
+#define DU_WPAN_AGGREGATE_H
+
+#include <ns3/core-module.h>
+#include <ns3/network-module.h>
+
+#include <ostream>
+#include <vector>
+
+namespace ns3
+{
+
+class AggregateHeader: public Header
+{
+    public:
+        static TypeId GetTypeId(void) {
+            static TypeId tid = TypeId("AggregateHeader")
+                .SetParent<Header>()
+                .SetGroupName("LrWpan")
+                .AddConstructor<AggregateHeader>();
+            return tid;
+        }
+
+        TypeId GetInstanceTypeId() const override
+        {
+            return GetTypeId();
+        }
+
+        // MSDU bytes of `count` readings of `size` bytes
+        static uint32_t GetMsduSize(uint32_t count, uint32_t size)
+        {
+            return 1 + count * (1 + size);
+        }
+
+        // most readings of `size` bytes in an MSDU of `maxMsduSize` bytes
+        static uint32_t GetCapacity(uint32_t maxMsduSize, uint32_t size)
+        {
+            return maxMsduSize > 1 ? (maxMsduSize - 1) / (1 + size) : 0;
+        }
+
+        void AddReading(uint32_t size)
+        {
+            NS_ABORT_MSG_IF(size > 255 || this->sizes.size() >= 255, "reading does not fit the aggregate header");
+            this->sizes.push_back(size);
+        }
+
+        uint32_t GetReadingCount() const
+        {
+            return this->sizes.size();
+        }
+
+        uint32_t GetReadingSize(uint32_t i) const
+        {
+            return this->sizes[i];
+        }
+
+        uint32_t GetSerializedSize() const override
+        {
+            return 1 + this->sizes.size();
+        }
+
+        void Serialize(Buffer::Iterator start) const override
+        {
+            start.WriteU8(this->sizes.size());
+            for(uint8_t size : this->sizes)
+            {
+                start.WriteU8(size);
+            }
+        }
+
+        uint32_t Deserialize(Buffer::Iterator start) override
+        {
+            this->sizes.assign(start.ReadU8(), 0);
+            for(uint8_t& size : this->sizes)
+            {
+                size = start.ReadU8();
+            }
+            return this->GetSerializedSize();
+        }
+
+        void Print(std::ostream& os) const override
+        {
+            os << "readings=" << this->sizes.size();
+        }
+
+        // one MSDU holding every reading in order
+        static Ptr<Packet> Pack(const std::vector<Ptr<Packet>>& readings)
+        {
+            AggregateHeader header;
+            Ptr<Packet> msdu = Create<Packet>();
+            for(const Ptr<Packet>& reading : readings)
+            {
+                header.AddReading(reading->GetSize());
+                msdu->AddAtEnd(reading);
+            }
+            msdu->AddHeader(header);
+            return msdu;
+        }
+
+        static std::vector<Ptr<Packet>> Unpack(Ptr<const Packet> msdu)
+        {
+            Ptr<Packet> copy = msdu->Copy();
+            AggregateHeader header;
+            copy->RemoveHeader(header);
+
+            std::vector<Ptr<Packet>> readings;
+            uint32_t offset = 0;
+            for(uint32_t i = 0; i < header.GetReadingCount(); i++)
+            {
+                uint32_t size = header.GetReadingSize(i);
+                if(offset + size > copy->GetSize())
+                {
+                    break; // truncated
+                }
+                readings.push_back(copy->CreateFragment(offset, size));
+                offset += size;
+            }
+            return readings;
+        }
+
+    private:
+        std::vector<uint8_t> sizes; // bytes of every reading
+};
+
+} // namespace ns3
+
+#endif /* DU_WPAN_AGGREGATE_H */
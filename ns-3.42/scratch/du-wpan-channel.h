@@ -0,0 +1,530 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Single-model spectrum channel with a parallel receiver fan-out.
+ *
+ * With Workers = 0 StartTx() is the loop of SingleModelSpectrumChannel. With
+ * Workers > 0 and enough receivers, one transmission is handled in phases:
+ *
+ *   1. serial   collect receivers, snapshot positions, antenna gains
+ *   2. workers  propagation loss, delay and linear gain per receiver
+ *   3. serial   traces, range check, copy of the signal parameters
+ *   4. workers  scale the copied PSDs
+ *   5. serial   schedule StartRx in receiver list order
+ *
+ * Workers never touch a shared Ptr (ns-3 reference counts are not atomic):
+ * they evaluate the loss and delay models on private mobility models that
+ * carry the snapshot positions. The results are therefore bit-identical to
+ * the serial loop as long as the models are deterministic functions of the
+ * two positions. With Workers > 0 the first transmission aborts on any loss or
+ * delay model outside of a known list (IsPositionOnly()): random (fading,
+ * shadowing) models and models that read objects aggregated to the node do not
+ * qualify. parallel-channel-test compares both fan-outs.
+ */
+
+#ifndef DU_WPAN_CHANNEL_H
+#define DU_WPAN_CHANNEL_H
+
+#include <ns3/antenna-module.h>
+#include <ns3/core-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/network-module.h>
+#include <ns3/propagation-module.h>
+#include <ns3/spectrum-module.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "du-wpan-spectrum-kernels.h"
+
+namespace ns3
+{
+
+/*
+ * Fixed set of threads running one ParallelFor at a time. The calling thread
+ * takes part as worker 0, so `threads` extra threads give threads + 1 workers.
+ */
+class ChannelWorkerPool
+{
+    public:
+        explicit ChannelWorkerPool(uint32_t threads)
+            : generation(0),
+              pending(0),
+              stop(false)
+        {
+            for(uint32_t t = 0; t < threads; t++)
+            {
+                this->threads.emplace_back(&ChannelWorkerPool::Loop, this, t + 1);
+            }
+        }
+
+        ~ChannelWorkerPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->stop = true;
+            }
+            this->wake.notify_all();
+            for(auto& thread : this->threads)
+            {
+                thread.join();
+            }
+        }
+
+        uint32_t GetWorkerCount() const
+        {
+            return this->threads.size() + 1;
+        }
+
+        // fn(worker, i) for every i in [0, n)
+        void ParallelFor(size_t n, const std::function<void(uint32_t, size_t)>& fn)
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->job = &fn;
+                this->size = n;
+                this->next.store(0);
+                this->pending = this->threads.size();
+                this->generation++;
+            }
+            this->wake.notify_all();
+
+            this->Work(0);
+
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->done.wait(lock, [this] { return this->pending == 0; });
+            this->job = nullptr;
+        }
+
+    private:
+        static constexpr size_t CHUNK = 16;
+
+        void Work(uint32_t worker)
+        {
+            while(true)
+            {
+                size_t begin = this->next.fetch_add(CHUNK);
+                if(begin >= this->size)
+                {
+                    return;
+                }
+                size_t end = std::min(begin + CHUNK, this->size);
+                for(size_t i = begin; i < end; i++)
+                {
+                    (*this->job)(worker, i);
+                }
+            }
+        }
+
+        void Loop(uint32_t worker)
+        {
+            uint64_t seen = 0;
+            while(true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(this->mutex);
+                    this->wake.wait(lock, [this, seen] { return this->stop || this->generation != seen; });
+                    if(this->stop)
+                    {
+                        return;
+                    }
+                    seen = this->generation;
+                }
+
+                this->Work(worker);
+
+                std::lock_guard<std::mutex> lock(this->mutex);
+                if(--this->pending == 0)
+                {
+                    this->done.notify_one();
+                }
+            }
+        }
+
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+        uint64_t generation;
+        size_t pending;
+        bool stop;
+
+        const std::function<void(uint32_t, size_t)>* job = nullptr;
+        size_t size = 0;
+        std::atomic<size_t> next{0};
+};
+
+class ParallelSpectrumChannel: public SpectrumChannel
+{
+    public:
+        static TypeId GetTypeId(void) {
+            static TypeId tid = TypeId("ParallelSpectrumChannel")
+                .SetParent<SpectrumChannel>()
+                .SetGroupName("Spectrum")
+                .AddConstructor<ParallelSpectrumChannel>()
+                .AddAttribute("Workers",
+                              "Extra threads for the receiver fan-out, 0 runs the serial loop",
+                              UintegerValue(0),
+                              MakeUintegerAccessor(&ParallelSpectrumChannel::workers),
+                              MakeUintegerChecker<uint32_t>())
+                .AddAttribute("ParallelThreshold",
+                              "Minimum number of receivers for the parallel fan-out",
+                              UintegerValue(64),
+                              MakeUintegerAccessor(&ParallelSpectrumChannel::threshold),
+                              MakeUintegerChecker<uint32_t>());
+            return tid;
+        }
+
+        ParallelSpectrumChannel()
+            : workers(0),
+              threshold(64),
+              checked(false)
+        {
+        }
+
+        // loss models whose result depends on the two positions only and that keep no state;
+        // the urban model is left out, CalcRxPower() and MoveNode() write its link cache
+        static bool IsPositionOnly(Ptr<PropagationLossModel> model)
+        {
+            static const std::set<std::string> names = {
+                "ns3::FriisPropagationLossModel",
+                "ns3::TwoRayGroundPropagationLossModel",
+                "ns3::LogDistancePropagationLossModel",
+                "ns3::ThreeLogDistancePropagationLossModel",
+                "ns3::RangePropagationLossModel",
+                "ns3::FixedRssLossModel",
+            };
+            for(; model; model = model->GetNext())
+            {
+                if(names.count(model->GetInstanceTypeId().GetName()) == 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static bool IsPositionOnly(Ptr<PropagationDelayModel> model)
+        {
+            return !model || model->GetInstanceTypeId().GetName() == "ns3::ConstantSpeedPropagationDelayModel";
+        }
+
+        void AddRx(Ptr<SpectrumPhy> phy) override
+        {
+            this->phyList.push_back(phy);
+        }
+
+        void RemoveRx(Ptr<SpectrumPhy> phy) override
+        {
+            auto it = std::find(this->phyList.begin(), this->phyList.end(), phy);
+            if(it != this->phyList.end())
+            {
+                this->phyList.erase(it);
+            }
+        }
+
+        std::size_t GetNDevices() const override
+        {
+            return this->phyList.size();
+        }
+
+        Ptr<NetDevice> GetDevice(std::size_t i) const override
+        {
+            return this->phyList.at(i)->GetDevice();
+        }
+
+        void StartTx(Ptr<SpectrumSignalParameters> txParams) override
+        {
+            NS_ASSERT_MSG(txParams->psd, "NULL txPsd");
+            NS_ASSERT_MSG(txParams->txPhy, "NULL txPhy");
+
+            m_txSigParamsTrace(txParams);
+
+            if(this->workers > 0 && !this->checked)
+            {
+                NS_ABORT_MSG_IF(!IsPositionOnly(m_propagationLoss),
+                                "parallel fan-out needs loss models that depend on the positions only");
+                NS_ABORT_MSG_IF(!IsPositionOnly(m_propagationDelay),
+                                "parallel fan-out needs ConstantSpeedPropagationDelayModel");
+                this->checked = true;
+            }
+
+            Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility();
+            Ptr<NetDevice> txNetDevice = txParams->txPhy->GetDevice();
+
+            // 1. receivers of this transmission
+            this->links.clear();
+            for(auto& rxPhy : this->phyList)
+            {
+                if(rxPhy == txParams->txPhy)
+                {
+                    continue;
+                }
+
+                Ptr<NetDevice> rxNetDevice = rxPhy->GetDevice();
+                if(rxNetDevice && txNetDevice && rxNetDevice->GetNode()->GetId() == txNetDevice->GetNode()->GetId())
+                {
+                    continue; // antennas of the same node, as in SingleModelSpectrumChannel
+                }
+                if(m_filter && m_filter->Filter(txParams, rxPhy))
+                {
+                    continue; // dropped by the transmit filters of the channel, before any loss
+                }
+
+                Link link;
+                link.phy = PeekPointer(rxPhy);
+                link.mobility = PeekPointer(rxPhy->GetMobility());
+                link.context = rxNetDevice ? rxNetDevice->GetNode()->GetId() : Simulator::NO_CONTEXT;
+                this->links.push_back(link);
+            }
+
+            bool parallel = this->workers > 0 && senderMobility && !m_spectrumPropagationLoss && this->links.size() >= this->threshold;
+            if(!parallel)
+            {
+                this->FanOutSerial(txParams, senderMobility);
+                return;
+            }
+
+            this->StartWorkers();
+
+            Vector txPosition = senderMobility->GetPosition();
+            for(auto& link : this->links)
+            {
+                link.hasMobility = link.mobility != nullptr;
+                if(!link.hasMobility)
+                {
+                    continue;
+                }
+                link.position = link.mobility->GetPosition();
+                link.antennaGainDb = this->AntennaGainDb(txParams, link.phy, senderMobility, link.mobility);
+                link.txAntennaGainDb = this->lastTxAntennaGainDb;
+                link.rxAntennaGainDb = this->lastRxAntennaGainDb;
+            }
+
+            // 2. loss and delay on per-worker mobility models
+            std::function<void(uint32_t, size_t)> propagate = [this, &txPosition](uint32_t worker, size_t i) {
+                Link& link = this->links[i];
+                if(!link.hasMobility)
+                {
+                    return;
+                }
+                Ptr<MobilityModel> tx = this->txProxies[worker];
+                Ptr<MobilityModel> rx = this->rxProxies[worker];
+                tx->SetPosition(txPosition);
+                rx->SetPosition(link.position);
+
+                link.propagationGainDb = m_propagationLoss ? m_propagationLoss->CalcRxPower(0, tx, rx) : 0;
+                link.pathLossDb = link.antennaGainDb - link.propagationGainDb;
+                link.gain = std::pow(10.0, (-link.pathLossDb) / 10.0);
+                link.delay = m_propagationDelay ? m_propagationDelay->GetDelay(tx, rx) : MicroSeconds(0);
+            };
+            this->pool->ParallelFor(this->links.size(), propagate);
+
+            // 3. traces and copies, in receiver order
+            for(auto& link : this->links)
+            {
+                link.rxParams = txParams->Copy();
+                link.delivered = true;
+                if(!link.hasMobility)
+                {
+                    link.gain = 1;
+                    link.delay = MicroSeconds(0);
+                    continue;
+                }
+                m_gainTrace(senderMobility, link.mobility, link.txAntennaGainDb, link.rxAntennaGainDb, link.propagationGainDb, link.pathLossDb);
+                m_pathLossTrace(txParams->txPhy, link.phy, link.pathLossDb);
+                if(link.pathLossDb > m_maxLossDb)
+                {
+                    link.delivered = false; // beyond range
+                    link.rxParams = nullptr;
+                }
+            }
+
+            // 4. PSD scaling
+            std::function<void(uint32_t, size_t)> scale = [this](uint32_t worker, size_t i) {
+                Link& link = this->links[i];
+                if(link.delivered && link.hasMobility)
+                {
+                    SpectrumKernels::Scale(*(link.rxParams->psd), link.gain);
+                }
+            };
+            this->pool->ParallelFor(this->links.size(), scale);
+
+            // 5. RX start events in the order of the serial loop
+            for(auto& link : this->links)
+            {
+                if(link.delivered)
+                {
+                    this->ScheduleRx(link.context, link.delay, link.rxParams, link.phy);
+                }
+                link.rxParams = nullptr;
+            }
+        }
+
+    protected:
+        void DoDispose() override
+        {
+            this->pool.reset();
+            this->txProxies.clear();
+            this->rxProxies.clear();
+            this->phyList.clear();
+            this->links.clear();
+            SpectrumChannel::DoDispose();
+        }
+
+    private:
+        struct Link
+        {
+            SpectrumPhy* phy;
+            MobilityModel* mobility;
+            uint32_t context;
+            bool hasMobility = false;
+            bool delivered = false;
+            Vector position;
+            double txAntennaGainDb = 0;
+            double rxAntennaGainDb = 0;
+            double antennaGainDb = 0;
+            double propagationGainDb = 0;
+            double pathLossDb = 0;
+            double gain = 1;
+            Time delay;
+            Ptr<SpectrumSignalParameters> rxParams;
+        };
+
+        // -(tx + rx) antenna gain, the single gains are kept for the gain trace
+        double AntennaGainDb(Ptr<SpectrumSignalParameters> txParams, SpectrumPhy* rxPhy, Ptr<MobilityModel> senderMobility, Ptr<MobilityModel> receiverMobility)
+        {
+            double txAntennaGain = 0;
+            double rxAntennaGain = 0;
+            if(txParams->txAntenna)
+            {
+                Angles txAngles(receiverMobility->GetPosition(), senderMobility->GetPosition());
+                txAntennaGain = txParams->txAntenna->GetGainDb(txAngles);
+            }
+            Ptr<AntennaModel> rxAntenna = DynamicCast<AntennaModel>(rxPhy->GetAntenna());
+            if(rxAntenna)
+            {
+                Angles rxAngles(senderMobility->GetPosition(), receiverMobility->GetPosition());
+                rxAntennaGain = rxAntenna->GetGainDb(rxAngles);
+            }
+            this->lastTxAntennaGainDb = txAntennaGain;
+            this->lastRxAntennaGainDb = rxAntennaGain;
+            return -txAntennaGain - rxAntennaGain;
+        }
+
+        // the loop of SingleModelSpectrumChannel::StartTx()
+        void FanOutSerial(Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> senderMobility)
+        {
+            for(auto& link : this->links)
+            {
+                Time delay = MicroSeconds(0);
+                Ptr<MobilityModel> receiverMobility = link.mobility;
+                Ptr<SpectrumSignalParameters> rxParams = txParams->Copy();
+
+                if(senderMobility && receiverMobility)
+                {
+                    double pathLossDb = this->AntennaGainDb(txParams, link.phy, senderMobility, receiverMobility);
+                    double propagationGainDb = 0;
+                    if(m_propagationLoss)
+                    {
+                        propagationGainDb = m_propagationLoss->CalcRxPower(0, senderMobility, receiverMobility);
+                        pathLossDb -= propagationGainDb;
+                    }
+                    m_gainTrace(senderMobility, receiverMobility, this->lastTxAntennaGainDb, this->lastRxAntennaGainDb, propagationGainDb, pathLossDb);
+                    m_pathLossTrace(txParams->txPhy, link.phy, pathLossDb);
+                    if(pathLossDb > m_maxLossDb)
+                    {
+                        continue; // beyond range
+                    }
+                    double pathGainLinear = std::pow(10.0, (-pathLossDb) / 10.0);
+                    SpectrumKernels::Scale(*(rxParams->psd), pathGainLinear);
+
+                    if(m_spectrumPropagationLoss)
+                    {
+                        rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity(rxParams, senderMobility, receiverMobility);
+                    }
+                    if(m_propagationDelay)
+                    {
+                        delay = m_propagationDelay->GetDelay(senderMobility, receiverMobility);
+                    }
+                }
+
+                this->ScheduleRx(link.context, delay, rxParams, link.phy);
+            }
+        }
+
+        void ScheduleRx(uint32_t context, Time delay, Ptr<SpectrumSignalParameters> rxParams, Ptr<SpectrumPhy> receiver)
+        {
+            if(context != Simulator::NO_CONTEXT)
+            {
+                Simulator::ScheduleWithContext(context, delay, &ParallelSpectrumChannel::StartRx, rxParams, receiver);
+            }
+            else
+            {
+                Simulator::Schedule(delay, &ParallelSpectrumChannel::StartRx, rxParams, receiver);
+            }
+        }
+
+        static void StartRx(Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
+        {
+            receiver->StartRx(params);
+        }
+
+        void StartWorkers()
+        {
+            if(this->pool)
+            {
+                return;
+            }
+            uint32_t threads = std::min<uint32_t>(this->workers, std::max(1u, std::thread::hardware_concurrency()) * 4);
+            this->pool.reset(new ChannelWorkerPool(threads));
+            for(uint32_t w = 0; w < this->pool->GetWorkerCount(); w++)
+            {
+                this->txProxies.push_back(CreateObject<ConstantPositionMobilityModel>());
+                this->rxProxies.push_back(CreateObject<ConstantPositionMobilityModel>());
+            }
+        }
+
+        uint32_t workers;
+        uint32_t threshold;
+        bool checked; // models verified for the parallel fan-out
+
+        std::vector<Ptr<SpectrumPhy>> phyList;
+        std::vector<Link> links; // receivers of the transmission being fanned out
+
+        std::unique_ptr<ChannelWorkerPool> pool;
+        std::vector<Ptr<MobilityModel>> txProxies; // one pair per worker
+        std::vector<Ptr<MobilityModel>> rxProxies;
+
+        double lastTxAntennaGainDb = 0;
+        double lastRxAntennaGainDb = 0;
+};
+
+} // namespace ns3
+
+#endif /* DU_WPAN_CHANNEL_H */
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Exchange between the processes of a spatially partitioned run.
+ *
+ * Every process simulates one region (a strip of PANs) with its own default
+ * simulator and advances in windows of one lookahead. At the end of a window
+ * the frames committed for other regions are exchanged in one all-to-all,
+ * and every region can inject them before any of them starts on air.
+ *
+ * ns-3's DistributedSimulatorImpl is not used: it derives the lookahead from
+ * point-to-point links between nodes of different systems, and the abstract
+ * medium is not an ns-3 channel. Without an MPI build (NS3_MPI undefined) there
+ * is a single region and nothing is exchanged.
+ */
+
+#ifndef DU_WPAN_DISTRIBUTED_H
+#define DU_WPAN_DISTRIBUTED_H
+
+#include <ns3/core-module.h>
+
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace ns3
+{
+
+class RegionExchange: public SimpleRefCount<RegionExchange>
+{
+    public:
+        RegionExchange(int* argc, char*** argv)
+            : rank(0),
+              size(1),
+              windows(0),
+              sent(0)
+        {
+            #ifdef NS3_MPI
+            MPI_Init(argc, argv);
+            MPI_Comm_rank(MPI_COMM_WORLD, &this->rank);
+            MPI_Comm_size(MPI_COMM_WORLD, &this->size);
+            #endif
+        }
+
+        void Finalize()
+        {
+            #ifdef NS3_MPI
+            MPI_Finalize();
+            #endif
+        }
+
+        uint32_t GetRegion() const // region simulated by this process
+        {
+            return this->rank;
+        }
+
+        uint32_t GetRegionCount() const
+        {
+            return this->size;
+        }
+
+        uint64_t GetWindowCount() const
+        {
+            return this->windows;
+        }
+
+        uint64_t GetSentCount() const // items sent to other regions
+        {
+            return this->sent;
+        }
+
+        // outbox[r] goes to region r, returns what the other regions sent to this one
+        template <typename T>
+        std::vector<T> Exchange(const std::vector<std::vector<T>>& outbox)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "sent as bytes");
+            this->windows++;
+            std::vector<T> received;
+            if(this->size == 1)
+            {
+                return received;
+            }
+
+            #ifdef NS3_MPI
+            std::vector<int> sendBytes(this->size, 0);
+            std::vector<int> sendOffsets(this->size, 0);
+            std::vector<char> send;
+            for(int r = 0; r < this->size && r < (int) outbox.size(); r++)
+            {
+                sendOffsets[r] = send.size();
+                sendBytes[r] = outbox[r].size() * sizeof(T);
+                const char* data = (const char*) outbox[r].data();
+                send.insert(send.end(), data, data + sendBytes[r]);
+                this->sent += r != this->rank ? outbox[r].size() : 0;
+            }
+
+            std::vector<int> receiveBytes(this->size, 0);
+            std::vector<int> receiveOffsets(this->size, 0);
+            MPI_Alltoall(sendBytes.data(), 1, MPI_INT, receiveBytes.data(), 1, MPI_INT, MPI_COMM_WORLD);
+            int total = 0;
+            for(int r = 0; r < this->size; r++)
+            {
+                receiveOffsets[r] = total;
+                total += receiveBytes[r];
+            }
+
+            std::vector<char> buffer(total);
+            MPI_Alltoallv(send.data(), sendBytes.data(), sendOffsets.data(), MPI_BYTE,
+                          buffer.data(), receiveBytes.data(), receiveOffsets.data(), MPI_BYTE,
+                          MPI_COMM_WORLD);
+            received.resize(total / sizeof(T));
+            std::memcpy((void*) received.data(), buffer.data(), total);
+            #endif
+            return received;
+        }
+
+        // element-wise over every region, result in every region
+        void Sum(std::vector<double>& values) const
+        {
+            #ifdef NS3_MPI
+            MPI_Allreduce(MPI_IN_PLACE, values.data(), values.size(), MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+            #endif
+        }
+
+        void Max(std::vector<double>& values) const
+        {
+            #ifdef NS3_MPI
+            MPI_Allreduce(MPI_IN_PLACE, values.data(), values.size(), MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+            #endif
+        }
+
+    private:
+        int rank;
+        int size;
+        uint64_t windows;
+        uint64_t sent;
+};
+
+} // namespace ns3
+
+#endif /* DU_WPAN_DISTRIBUTED_H */
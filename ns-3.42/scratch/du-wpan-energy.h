@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Radio energy model of LR-WPAN devices for the ns-3 energy module.
+ *
+ * ns-3 has no DeviceEnergyModel for lr-wpan, so the radio state is taken from
+ * the "TrxState" trace of LrWpanPhy (or reported with ChangeState() by the
+ * abstract medium) and drawn from an EnergySource such as BasicEnergySource at
+ * the current of that state. Default currents are the CC2420 datasheet values
+ * at 3 V (TX at 0 dBm).
+ *
+ *   TX    : TX_ON, BUSY_TX
+ *   RX    : BUSY_RX
+ *   IDLE  : RX_ON (listening)
+ *   SLEEP : TRX_OFF, FORCE_TRX_OFF
+ *
+ * When the source is drained the model calls the depletion callback, which
+ * switches the device off.
+ */
+
+#ifndef DU_WPAN_ENERGY_H
+#define DU_WPAN_ENERGY_H
+
+#include <ns3/core-module.h>
+#include <ns3/energy-module.h>
+#include <ns3/lr-wpan-module.h>
+#include <ns3/network-module.h>
+
+namespace ns3
+{
+
+// ns3::energy since ns-3.42, plain ns3 before
+namespace energy
+{
+}
+using namespace energy;
+
+class LrWpanRadioEnergyModel: public DeviceEnergyModel
+{
+    public:
+        enum RadioState
+        {
+            RADIO_TX = 0,
+            RADIO_RX,
+            RADIO_IDLE,
+            RADIO_SLEEP,
+            RADIO_STATE_COUNT
+        };
+
+        typedef Callback<void> DepletionCallback;
+
+        static TypeId GetTypeId(void) {
+            static TypeId tid = TypeId("LrWpanRadioEnergyModel")
+                .SetParent<DeviceEnergyModel>()
+                .SetGroupName("Energy")
+                .AddConstructor<LrWpanRadioEnergyModel>()
+                .AddAttribute("TxCurrentA",
+                              "Current while transmitting (A)",
+                              DoubleValue(0.0174),
+                              MakeDoubleAccessor(&LrWpanRadioEnergyModel::SetTxCurrent),
+                              MakeDoubleChecker<double>(0))
+                .AddAttribute("RxCurrentA",
+                              "Current while receiving a frame (A)",
+                              DoubleValue(0.0188),
+                              MakeDoubleAccessor(&LrWpanRadioEnergyModel::SetRxCurrent),
+                              MakeDoubleChecker<double>(0))
+                .AddAttribute("IdleCurrentA",
+                              "Current while the receiver is on without a frame (A)",
+                              DoubleValue(0.0188),
+                              MakeDoubleAccessor(&LrWpanRadioEnergyModel::SetIdleCurrent),
+                              MakeDoubleChecker<double>(0))
+                .AddAttribute("SleepCurrentA",
+                              "Current while the transceiver is off (A)",
+                              DoubleValue(0.000426),
+                              MakeDoubleAccessor(&LrWpanRadioEnergyModel::SetSleepCurrent),
+                              MakeDoubleChecker<double>(0));
+            return tid;
+        }
+
+        LrWpanRadioEnergyModel()
+            : state(RADIO_SLEEP), // LrWpanPhy starts in TRX_OFF
+              depleted(false)
+        {
+            this->current[RADIO_TX] = 0.0174;
+            this->current[RADIO_RX] = 0.0188;
+            this->current[RADIO_IDLE] = 0.0188;
+            this->current[RADIO_SLEEP] = 0.000426;
+        }
+
+        void SetTxCurrent(double ampere) { this->current[RADIO_TX] = ampere; }
+        void SetRxCurrent(double ampere) { this->current[RADIO_RX] = ampere; }
+        void SetIdleCurrent(double ampere) { this->current[RADIO_IDLE] = ampere; }
+        void SetSleepCurrent(double ampere) { this->current[RADIO_SLEEP] = ampere; }
+
+        void SetEnergySource(Ptr<EnergySource> source) override
+        {
+            this->source = source;
+            this->lastChange = Simulator::Now();
+        }
+
+        Ptr<EnergySource> GetEnergySource() const
+        {
+            return this->source;
+        }
+
+        // radio state from the PHY
+        void SetPhy(Ptr<lrwpan::LrWpanPhy> phy)
+        {
+            phy->TraceConnectWithoutContext("TrxState", MakeCallback(&LrWpanRadioEnergyModel::TrxStateChanged, this));
+        }
+
+        // called once the source is drained, the owner switches the device off
+        void SetDepletionCallback(DepletionCallback callback)
+        {
+            this->depletion = callback;
+        }
+
+        // newState is a RadioState
+        void ChangeState(int newState) override
+        {
+            if(newState == this->state)
+            {
+                return;
+            }
+            Time now = Simulator::Now();
+            this->stateTime[this->state] += now - this->lastChange;
+            this->lastChange = now;
+
+            // the source draws the current of the old state up to now
+            if(this->source)
+            {
+                this->source->UpdateEnergySource();
+            }
+            this->state = RadioState(newState);
+        }
+
+        double GetTotalEnergyConsumption() const override // J, up to now
+        {
+            double total = 0;
+            for(int s = 0; s < RADIO_STATE_COUNT; s++)
+            {
+                total += this->GetStateEnergy(RadioState(s));
+            }
+            return total;
+        }
+
+        void HandleEnergyDepletion() override
+        {
+            if(this->depleted)
+            {
+                return;
+            }
+            this->depleted = true;
+            // not from inside UpdateEnergySource(), switching off changes the state again
+            Simulator::ScheduleNow(&LrWpanRadioEnergyModel::NotifyDepletion, this);
+        }
+
+        void HandleEnergyRecharged() override
+        {
+            this->depleted = false;
+        }
+
+        void HandleEnergyChanged() override
+        {
+        }
+
+        bool IsDepleted() const
+        {
+            return this->depleted;
+        }
+
+        Time GetStateTime(RadioState s) const // up to now
+        {
+            Time t = this->stateTime[s];
+            if(s == this->state)
+            {
+                t += Simulator::Now() - this->lastChange;
+            }
+            return t;
+        }
+
+        double GetStateEnergy(RadioState s) const // J, up to now
+        {
+            double voltage = this->source ? this->source->GetSupplyVoltage() : 0;
+            return this->GetStateTime(s).GetSeconds() * this->current[s] * voltage;
+        }
+
+        static RadioState FromPhyState(lrwpan::PhyEnumeration phyState)
+        {
+            switch(phyState)
+            {
+                case lrwpan::IEEE_802_15_4_PHY_TX_ON:
+                case lrwpan::IEEE_802_15_4_PHY_BUSY_TX:
+                    return RADIO_TX;
+                case lrwpan::IEEE_802_15_4_PHY_BUSY_RX:
+                    return RADIO_RX;
+                case lrwpan::IEEE_802_15_4_PHY_TRX_OFF:
+                case lrwpan::IEEE_802_15_4_PHY_FORCE_TRX_OFF:
+                    return RADIO_SLEEP;
+                default:
+                    return RADIO_IDLE;
+            }
+        }
+
+    private:
+        double DoGetCurrentA() const override
+        {
+            return this->current[this->state];
+        }
+
+        void TrxStateChanged(Time now, lrwpan::PhyEnumeration oldState, lrwpan::PhyEnumeration newState)
+        {
+            this->ChangeState(FromPhyState(newState));
+        }
+
+        void NotifyDepletion()
+        {
+            if(!this->depletion.IsNull())
+            {
+                this->depletion();
+            }
+        }
+
+        void DoDispose() override
+        {
+            this->source = nullptr;
+            this->depletion = DepletionCallback();
+            DeviceEnergyModel::DoDispose();
+        }
+
+        double current[RADIO_STATE_COUNT]; // A
+        Time stateTime[RADIO_STATE_COUNT];
+        RadioState state;
+        Time lastChange;
+        bool depleted;
+        Ptr<EnergySource> source;
+        DepletionCallback depletion;
+};
+
+// LrWpanRadioEnergyModel on the PHY of LrWpanNetDevices, like WifiRadioEnergyModelHelper
+class LrWpanRadioEnergyModelHelper: public DeviceEnergyModelHelper
+{
+    public:
+        LrWpanRadioEnergyModelHelper()
+        {
+            this->radioEnergy.SetTypeId(LrWpanRadioEnergyModel::GetTypeId());
+        }
+
+        void Set(std::string name, const AttributeValue& v) override
+        {
+            this->radioEnergy.Set(name, v);
+        }
+
+    private:
+        Ptr<DeviceEnergyModel> DoInstall(Ptr<NetDevice> device, Ptr<EnergySource> source) const override
+        {
+            Ptr<lrwpan::LrWpanNetDevice> lrWpanNetDevice = DynamicCast<lrwpan::LrWpanNetDevice>(device);
+            NS_ABORT_MSG_IF(!lrWpanNetDevice, "LrWpanRadioEnergyModel needs an LrWpanNetDevice");
+
+            Ptr<LrWpanRadioEnergyModel> model = this->radioEnergy.Create<LrWpanRadioEnergyModel>();
+            model->SetEnergySource(source);
+            source->AppendDeviceEnergyModel(model);
+            model->SetPhy(lrWpanNetDevice->GetPhy());
+            return model;
+        }
+
+        ObjectFactory radioEnergy;
+};
+
+} // namespace ns3
+
+#endif /* DU_WPAN_ENERGY_H */
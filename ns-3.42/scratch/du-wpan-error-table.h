@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Lookup table for the chunk success rate of LrWpanErrorModel, used by the
+ * receivers of the abstract medium (du-wpan-abstract.h, --exactErrorModel
+ * switches it off). LrWpanPhy keeps calling its own LrWpanErrorModel: the
+ * model is a private member of the PHY and its method is not virtual.
+ *
+ * The O-QPSK error model of ns-3 computes for every chunk
+ *
+ *   BER     = 8/15 * 1/16 * sum_{k=2..16} (-1)^k C(16,k) exp(20 snr (1/k - 1))
+ *   success = (1 - BER)^nbits
+ *
+ * which is 15 exponentials and a pow per call. The chunk length enters only
+ * as an exponent, success = exp(nbits * L(snr)) with L = ln(1 - BER), so one
+ * table over SINR covers every chunk length. The table stores ln(-L) on a
+ * uniform dB grid, which is smooth over the whole range, and interpolates
+ * linearly. Outside the grid the exact formula is used.
+ *
+ * With y = ln(-L) off by at most e, the success rate p = exp(-nbits e^y) is
+ * off by at most |p ln p| e <= e / exp(1), for any chunk length. The largest e
+ * is measured over the grid midpoints when the table is built, see
+ * GetMaxError(). The table is built once the attributes are set, at
+ * construction, so no lookup during the run pays for it. The default 0.01 dB step gives e of about 1e-4, reached at
+ * high SINR where the success rate is 1 anyway, so chunk success rates are
+ * within 4e-5; against LrWpanErrorModel the observed deviation is ~2e-6.
+ */
+
+#ifndef DU_WPAN_ERROR_TABLE_H
+#define DU_WPAN_ERROR_TABLE_H
+
+#include <ns3/core-module.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace ns3
+{
+
+class LrWpanChunkSuccessTable: public Object
+{
+    public:
+        static TypeId GetTypeId(void) {
+            static TypeId tid = TypeId("LrWpanChunkSuccessTable")
+                .SetParent<Object>()
+                .SetGroupName("LrWpan")
+                .AddConstructor<LrWpanChunkSuccessTable>()
+                .AddAttribute("MinSinrDb",
+                              "Lower end of the table (dB)",
+                              DoubleValue(-30),
+                              MakeDoubleAccessor(&LrWpanChunkSuccessTable::minDb),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("MaxSinrDb",
+                              "Upper end of the table (dB), the BER is below 1e-40 beyond it",
+                              DoubleValue(12),
+                              MakeDoubleAccessor(&LrWpanChunkSuccessTable::maxDb),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("StepDb",
+                              "Grid step (dB)",
+                              DoubleValue(0.01),
+                              MakeDoubleAccessor(&LrWpanChunkSuccessTable::stepDb),
+                              MakeDoubleChecker<double>(1e-4))
+                .AddAttribute("Exact",
+                              "Evaluate the formula of LrWpanErrorModel instead of the table",
+                              BooleanValue(false),
+                              MakeBooleanAccessor(&LrWpanChunkSuccessTable::exact),
+                              MakeBooleanChecker());
+            return tid;
+        }
+
+        LrWpanChunkSuccessTable()
+            : minDb(-30),
+              maxDb(12),
+              stepDb(0.01),
+              exact(false),
+              maxError(0)
+        {
+        }
+
+        // ln(1 - BER) of LrWpanErrorModel for a linear SNR
+        static double ExactLogSuccess(double snr)
+        {
+            static const double coefficients[17] = {
+                0, 0, 120, -560, 1820, -4368, 8008, -11440, 12870,
+                -11440, 8008, -4368, 1820, -560, 120, -16, 1
+            }; // (-1)^k C(16,k)
+
+            double sum = 0;
+            for(uint32_t k = 2; k <= 16; k++)
+            {
+                sum += coefficients[k] * std::exp(20.0 * snr * (1.0 / k - 1.0));
+            }
+            double ber = std::min(std::max(8.0 / 15.0 * 1.0 / 16.0 * sum, 0.0), 1.0);
+            return std::log1p(-ber);
+        }
+
+        void SetExact(bool exact)
+        {
+            this->exact = exact;
+        }
+
+        // ln of the success rate of one chunk, add these up over a reception
+        double GetLogChunkSuccessRate(double snr, uint32_t nbits) const
+        {
+            return nbits * this->LogSuccess(snr);
+        }
+
+        // largest deviation of ln(-ln(1 - BER)) found over the grid midpoints
+        double GetMaxError() const
+        {
+            return this->maxError;
+        }
+
+        // bound on the absolute error of a chunk success rate
+        double GetSuccessRateErrorBound() const
+        {
+            return this->GetMaxError() / std::exp(1.0);
+        }
+
+        uint32_t GetSize() const
+        {
+            return this->table.size();
+        }
+
+    protected:
+        // attributes are set by now, the grid is final
+        void NotifyConstructionCompleted() override
+        {
+            this->Build();
+            Object::NotifyConstructionCompleted();
+        }
+
+    private:
+        double LogSuccess(double snr) const
+        {
+            if(this->exact || snr <= 0)
+            {
+                return ExactLogSuccess(snr);
+            }
+
+            double x = (10.0 * std::log10(snr) - this->minDb) / this->stepDb;
+            if(x < 0 || x >= this->table.size() - 1)
+            {
+                return ExactLogSuccess(snr);
+            }
+            uint32_t i = (uint32_t) x;
+            double f = x - i;
+            double y = this->table[i] + f * (this->table[i + 1] - this->table[i]);
+            return -std::exp(y);
+        }
+
+        static double Node(double db)
+        {
+            return std::log(-ExactLogSuccess(std::pow(10.0, db / 10.0)));
+        }
+
+        void Build()
+        {
+            uint32_t n = (uint32_t) std::ceil((this->maxDb - this->minDb) / this->stepDb) + 1;
+            this->table.resize(n);
+            for(uint32_t i = 0; i < n; i++)
+            {
+                this->table[i] = Node(this->minDb + i * this->stepDb);
+            }
+
+            // interpolation error is largest between the nodes
+            this->maxError = 0;
+            for(uint32_t i = 0; i + 1 < n; i++)
+            {
+                double midpoint = 0.5 * (this->table[i] + this->table[i + 1]);
+                double exact = Node(this->minDb + (i + 0.5) * this->stepDb);
+                this->maxError = std::max(this->maxError, std::abs(midpoint - exact));
+            }
+        }
+
+        double minDb;
+        double maxDb;
+        double stepDb;
+        bool exact;
+
+        std::vector<double> table; // ln(-ln(1 - BER)) per grid point
+        double maxError;
+};
+
+} // namespace ns3
+
+#endif /* DU_WPAN_ERROR_TABLE_H */
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Uniform grid of points in the x-y plane.
+ *
+ * With the cell size set to the interference range, every point within range
+ * of a position lies in the 3x3 cells around it. A point that moves is taken
+ * out of its old cell and put into the new one only when the cell changes.
+ */
+
+#ifndef DU_WPAN_GRID_H
+#define DU_WPAN_GRID_H
+
+#include <ns3/core-module.h>
+#include <ns3/mobility-module.h>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class SpatialGrid
+{
+    public:
+        SpatialGrid()
+            : cellSize(1)
+        {
+        }
+
+        // drops every point
+        void Reset(double cellSize)
+        {
+            NS_ABORT_MSG_IF(!(cellSize > 0), "grid cell size must be positive");
+            this->cellSize = cellSize;
+            this->cells.clear();
+        }
+
+        double GetCellSize() const
+        {
+            return this->cellSize;
+        }
+
+        void Insert(uint32_t id, const Vector& position)
+        {
+            this->cells[this->KeyOf(position)].push_back(id);
+        }
+
+        void Remove(uint32_t id, const Vector& position)
+        {
+            auto cell = this->cells.find(this->KeyOf(position));
+            if(cell == this->cells.end())
+            {
+                return;
+            }
+            std::vector<uint32_t>& ids = cell->second;
+            ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+            if(ids.empty())
+            {
+                this->cells.erase(cell);
+            }
+        }
+
+        // returns true when the point changed cells
+        bool Move(uint32_t id, const Vector& from, const Vector& to)
+        {
+            if(this->KeyOf(from) == this->KeyOf(to))
+            {
+                return false;
+            }
+            this->Remove(id, from);
+            this->Insert(id, to);
+            return true;
+        }
+
+        // every point in the 3x3 cells around `position`, itself included
+        template <typename F>
+        void ForEachNear(const Vector& position, F f) const
+        {
+            int64_t cx = this->CellOf(position.x);
+            int64_t cy = this->CellOf(position.y);
+            for(int64_t dx = -1; dx <= 1; dx++)
+            {
+                for(int64_t dy = -1; dy <= 1; dy++)
+                {
+                    auto cell = this->cells.find(CellKey(cx + dx, cy + dy));
+                    if(cell == this->cells.end())
+                    {
+                        continue;
+                    }
+                    for(uint32_t id : cell->second)
+                    {
+                        f(id);
+                    }
+                }
+            }
+        }
+
+    private:
+        int64_t CellOf(double coordinate) const
+        {
+            return (int64_t) std::floor(coordinate / this->cellSize);
+        }
+
+        uint64_t KeyOf(const Vector& position) const
+        {
+            return CellKey(this->CellOf(position.x), this->CellOf(position.y));
+        }
+
+        static uint64_t CellKey(int64_t x, int64_t y)
+        {
+            return ((uint64_t) (uint32_t) x << 32) | (uint32_t) y;
+        }
+
+        double cellSize; // m
+        std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+};
+
+} // namespace ns3
+
+#endif /* DU_WPAN_GRID_H */
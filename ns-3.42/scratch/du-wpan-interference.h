@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Incremental interference accumulator of one device of the abstract medium
+ * (du-wpan-abstract.h).
+ *
+ * LrWpanPhy takes the SINR of a chunk as
+ *
+ *   TotalAvgPower(rx) / TotalAvgPower(noise + signals - rx)
+ *
+ * where TotalAvgPower() sums the PSD over the bands of the current channel.
+ * The sum is linear, so the medium hands over each signal as its in-channel
+ * power and the receiver only keeps a scalar total:
+ *
+ *   Add / Remove   O(1), compensated (Neumaier) running sum
+ *   GetSinr        O(1), own / (noise + total - own)
+ *   chunks         closed on every change for the receptions being tracked
+ *
+ * The running sum is recomputed from the active signals every `resumPeriod`
+ * updates and set to exactly zero when the medium becomes idle, which bounds
+ * the drift of long runs.
+ *
+ * The spectrum PHY mode is not affected: LrWpanPhy creates and owns its
+ * LrWpanInterferenceHelper as a private member, so a scratch program cannot
+ * swap this accumulator in.
+ */
+
+#ifndef DU_WPAN_INTERFERENCE_H
+#define DU_WPAN_INTERFERENCE_H
+
+#include <ns3/core-module.h>
+
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class InterferenceAccumulator: public SimpleRefCount<InterferenceAccumulator>
+{
+    public:
+        typedef uint64_t SignalId;
+
+        // interval of a reception with constant SINR
+        struct Chunk
+        {
+            Time duration;
+            double sinr;
+        };
+
+        InterferenceAccumulator(double noise, uint32_t resumPeriod = 1024)
+            : noise(noise),
+              resumPeriod(resumPeriod),
+              nextId(1),
+              total(0),
+              compensation(0),
+              updates(0)
+        {
+        }
+
+        SignalId Add(double power) // W, in channel
+        {
+            this->CloseChunks();
+
+            SignalId id = this->nextId++;
+            this->signals[id] = power;
+            this->Accumulate(power);
+            return id;
+        }
+
+        void Remove(SignalId id)
+        {
+            auto it = this->signals.find(id);
+            if(it == this->signals.end())
+            {
+                return;
+            }
+            this->receptions.erase(id);
+            this->CloseChunks();
+
+            double power = it->second;
+            this->signals.erase(it);
+            if(this->signals.empty())
+            {
+                this->total = 0; // idle medium, drop the rounding residue
+                this->compensation = 0;
+                return;
+            }
+            this->Accumulate(-power);
+        }
+
+        double GetTotal() const // W, all active signals
+        {
+            return this->total + this->compensation;
+        }
+
+        double GetPower(SignalId id) const
+        {
+            auto it = this->signals.find(id);
+            return it == this->signals.end() ? 0 : it->second;
+        }
+
+        double GetInterference(SignalId id) const // W, every other signal
+        {
+            return std::max(this->GetTotal() - this->GetPower(id), 0.0);
+        }
+
+        double GetSinr(SignalId id) const
+        {
+            return this->GetPower(id) / (this->noise + this->GetInterference(id));
+        }
+
+        // record the SINR chunks of `id` until EndReception()
+        void StartReception(SignalId id)
+        {
+            Reception& reception = this->receptions[id];
+            reception.chunkStart = Simulator::Now();
+            reception.chunks.clear();
+        }
+
+        // chunks of the reception, call before Remove(id)
+        std::vector<Chunk> EndReception(SignalId id)
+        {
+            auto it = this->receptions.find(id);
+            if(it == this->receptions.end())
+            {
+                return {};
+            }
+            this->CloseChunk(id, it->second);
+            std::vector<Chunk> chunks = std::move(it->second.chunks);
+            this->receptions.erase(it);
+            return chunks;
+        }
+
+    private:
+        struct Reception
+        {
+            Time chunkStart;
+            std::vector<Chunk> chunks;
+        };
+
+        // Neumaier summation, the compensation keeps the low-order bits
+        void Accumulate(double value)
+        {
+            double sum = this->total + value;
+            if(std::abs(this->total) >= std::abs(value))
+            {
+                this->compensation += (this->total - sum) + value;
+            }
+            else
+            {
+                this->compensation += (value - sum) + this->total;
+            }
+            this->total = sum;
+
+            if(this->resumPeriod > 0 && ++this->updates >= this->resumPeriod)
+            {
+                this->Resum();
+            }
+        }
+
+        void Resum()
+        {
+            this->updates = 0;
+            this->total = 0;
+            this->compensation = 0;
+            uint32_t period = this->resumPeriod;
+            this->resumPeriod = 0; // no recursion
+            for(auto& signal : this->signals)
+            {
+                this->Accumulate(signal.second);
+            }
+            this->resumPeriod = period;
+        }
+
+        void CloseChunk(SignalId id, Reception& reception)
+        {
+            Time now = Simulator::Now();
+            if(now > reception.chunkStart)
+            {
+                reception.chunks.push_back({now - reception.chunkStart, this->GetSinr(id)});
+            }
+            reception.chunkStart = now;
+        }
+
+        // the SINR of every tracked reception changes with the total
+        void CloseChunks()
+        {
+            for(auto& reception : this->receptions)
+            {
+                this->CloseChunk(reception.first, reception.second);
+            }
+        }
+
+        double noise; // W, in channel
+        uint32_t resumPeriod;
+
+        SignalId nextId;
+        std::unordered_map<SignalId, double> signals; // active signals, W in channel
+        std::unordered_map<SignalId, Reception> receptions;
+
+        double total;
+        double compensation;
+        uint32_t updates; // since the last resummation
+};
+
+} // namespace ns3
+
+#endif /* DU_WPAN_INTERFERENCE_H */
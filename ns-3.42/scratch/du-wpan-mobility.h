@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Periodic position updates for mobile devices.
+ *
+ * A mobile device keeps its ConstantPositionMobilityModel; a trajectory model
+ * (random walk for pedestrians, random waypoint for vehicles) runs beside it
+ * and is sampled every Interval. When the sampled position differs, it is
+ * copied to the device and the `moved` callback updates whatever indexes the
+ * position (link tables, spatial grids). Between samples every model sees the
+ * same piecewise-constant position, so cached links never go stale.
+ */
+
+#ifndef DU_WPAN_MOBILITY_H
+#define DU_WPAN_MOBILITY_H
+
+#include <ns3/core-module.h>
+#include <ns3/mobility-module.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class MobilitySampler: public Object
+{
+    public:
+        static TypeId GetTypeId(void) {
+            static TypeId tid = TypeId("MobilitySampler")
+                .SetParent<Object>()
+                .SetGroupName("Mobility")
+                .AddConstructor<MobilitySampler>()
+                .AddAttribute("Interval",
+                              "Time between two position samples",
+                              TimeValue(Seconds(1)),
+                              MakeTimeAccessor(&MobilitySampler::interval),
+                              MakeTimeChecker());
+            return tid;
+        }
+
+        MobilitySampler()
+            : interval(Seconds(1)),
+              moves(0)
+        {
+        }
+
+        // trajectory of a mobile device: "pedestrian" or "vehicle", kept inside `bounds`
+        static Ptr<MobilityModel> CreateTrajectory(std::string kind, Vector start, Rectangle bounds)
+        {
+            Ptr<MobilityModel> trajectory;
+            if(kind == "pedestrian")
+            {
+                trajectory = CreateObject<RandomWalk2dMobilityModel>();
+                trajectory->SetAttribute("Bounds", RectangleValue(bounds));
+                trajectory->SetAttribute("Speed", StringValue("ns3::UniformRandomVariable[Min=0.5|Max=1.5]"));
+                trajectory->SetAttribute("Mode", StringValue("Time"));
+                trajectory->SetAttribute("Time", TimeValue(Seconds(10)));
+            }
+            else if(kind == "vehicle")
+            {
+                Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable>();
+                x->SetAttribute("Min", DoubleValue(bounds.xMin));
+                x->SetAttribute("Max", DoubleValue(bounds.xMax));
+                Ptr<UniformRandomVariable> y = CreateObject<UniformRandomVariable>();
+                y->SetAttribute("Min", DoubleValue(bounds.yMin));
+                y->SetAttribute("Max", DoubleValue(bounds.yMax));
+
+                Ptr<RandomRectanglePositionAllocator> waypoints = CreateObject<RandomRectanglePositionAllocator>();
+                waypoints->SetX(x);
+                waypoints->SetY(y);
+                waypoints->SetZ(start.z);
+
+                trajectory = CreateObject<RandomWaypointMobilityModel>();
+                trajectory->SetAttribute("Speed", StringValue("ns3::UniformRandomVariable[Min=2|Max=8]"));
+                trajectory->SetAttribute("Pause", StringValue("ns3::ConstantRandomVariable[Constant=2]"));
+                trajectory->SetAttribute("PositionAllocator", PointerValue(waypoints));
+            }
+            else
+            {
+                NS_ABORT_MSG("unknown mobility: " << kind);
+            }
+
+            start.x = std::min(std::max(start.x, bounds.xMin), bounds.xMax);
+            start.y = std::min(std::max(start.y, bounds.yMin), bounds.yMax);
+            trajectory->SetPosition(start);
+            trajectory->Initialize();
+            return trajectory;
+        }
+
+        void AddDevice(Ptr<MobilityModel> trajectory, Ptr<MobilityModel> position, Callback<void, Vector> moved)
+        {
+            this->devices.push_back({trajectory, position, moved});
+        }
+
+        void Start()
+        {
+            if(!this->devices.empty())
+            {
+                Simulator::Schedule(this->interval, &MobilitySampler::Sample, this);
+            }
+        }
+
+        uint32_t GetDeviceCount() const
+        {
+            return (uint32_t) this->devices.size();
+        }
+
+        uint64_t GetMoveCount() const
+        {
+            return this->moves;
+        }
+
+    private:
+        struct MobileDevice
+        {
+            Ptr<MobilityModel> trajectory;
+            Ptr<MobilityModel> position;
+            Callback<void, Vector> moved;
+        };
+
+        void Sample()
+        {
+            for(MobileDevice& device : this->devices)
+            {
+                Vector next = device.trajectory->GetPosition();
+                Vector current = device.position->GetPosition();
+                if(next.x == current.x && next.y == current.y && next.z == current.z)
+                {
+                    continue;
+                }
+                device.position->SetPosition(next);
+                device.moved(next);
+                this->moves++;
+            }
+            Simulator::Schedule(this->interval, &MobilitySampler::Sample, this);
+        }
+
+        Time interval;
+        uint64_t moves;
+        std::vector<MobileDevice> devices;
+};
+
+} // namespace ns3
+
+#endif /* DU_WPAN_MOBILITY_H */
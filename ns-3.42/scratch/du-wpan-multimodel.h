@@ -0,0 +1,407 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Multi-model spectrum channel for LR-WPAN, BLE and Wi-Fi on one medium.
+ *
+ * Receivers are grouped by spectrum model as in MultiModelSpectrumChannel.
+ * The overlap weights between every pair of models are computed once, when
+ * the second model of the pair shows up, and kept as a sparse matrix: target
+ * band j takes sum_i w_ij * psd_i with w_ij = overlap(i, j) / width(j).
+ *
+ * A transmission only occupies a few bands of its model (one LR-WPAN or BLE
+ * channel, one Wi-Fi channel), so the channel first finds the occupied bands
+ * of the TX PSD. Receiver models whose bands do not overlap them are skipped
+ * as a whole, without the per-receiver copy, loss computation and RX event
+ * that MultiModelSpectrumChannel spends on an all-zero signal. Everything
+ * else (receiver order, traces, loss, delay) is the loop of
+ * MultiModelSpectrumChannel.
+ */
+
+#ifndef DU_WPAN_MULTIMODEL_H
+#define DU_WPAN_MULTIMODEL_H
+
+#include <ns3/antenna-module.h>
+#include <ns3/core-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/network-module.h>
+#include <ns3/propagation-module.h>
+#include <ns3/spectrum-module.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "du-wpan-spectrum-kernels.h"
+
+namespace ns3
+{
+
+/*
+ * Sparse conversion from one spectrum model to another, rows by target band.
+ * For every source band the range of target bands it reaches is kept too, so
+ * the target bands of an occupied source range are found without a scan.
+ */
+class SpectrumOverlap: public SimpleRefCount<SpectrumOverlap>
+{
+    public:
+        SpectrumOverlap(Ptr<const SpectrumModel> from, Ptr<const SpectrumModel> to)
+            : to(to)
+        {
+            std::vector<BandInfo> sources(from->Begin(), from->End());
+            this->firstTarget.assign(sources.size(), -1);
+            this->lastTarget.assign(sources.size(), -1);
+            this->rowOffsets.push_back(0);
+
+            int32_t j = 0;
+            for(Bands::const_iterator target = to->Begin(); target != to->End(); target++, j++)
+            {
+                double width = target->fh - target->fl;
+                for(int32_t i = 0; i < (int32_t) sources.size(); i++)
+                {
+                    double overlap = std::min(sources[i].fh, target->fh) - std::max(sources[i].fl, target->fl);
+                    if(overlap <= 0)
+                    {
+                        continue;
+                    }
+                    this->sources.push_back(i);
+                    this->weights.push_back(overlap / width);
+                    if(this->firstTarget[i] < 0)
+                    {
+                        this->firstTarget[i] = j;
+                    }
+                    this->lastTarget[i] = j;
+                }
+                this->rowOffsets.push_back(this->sources.size());
+            }
+        }
+
+        bool IsOrthogonal() const
+        {
+            return this->weights.empty();
+        }
+
+        uint32_t GetWeightCount() const
+        {
+            return this->weights.size();
+        }
+
+        // `psd` in the target model, nullptr when its bands [first, last] reach no target band
+        Ptr<SpectrumValue> Convert(const SpectrumValue& psd, uint32_t first, uint32_t last) const
+        {
+            int32_t begin = -1;
+            for(uint32_t i = first; i <= last && begin < 0; i++)
+            {
+                begin = this->firstTarget[i];
+            }
+            int32_t end = -1;
+            for(uint32_t i = last + 1; i > first && end < 0; i--)
+            {
+                end = this->lastTarget[i - 1];
+            }
+            if(begin < 0)
+            {
+                return nullptr;
+            }
+
+            Ptr<SpectrumValue> converted = Create<SpectrumValue>(this->to);
+            for(int32_t j = begin; j <= end; j++)
+            {
+                double value = 0;
+                for(uint32_t k = this->rowOffsets[j]; k < this->rowOffsets[j + 1]; k++)
+                {
+                    value += this->weights[k] * psd[this->sources[k]];
+                }
+                (*converted)[j] = value;
+            }
+            return converted;
+        }
+
+    private:
+        Ptr<const SpectrumModel> to;
+        std::vector<uint32_t> rowOffsets;  // target band j: entries [rowOffsets[j], rowOffsets[j + 1])
+        std::vector<uint32_t> sources;
+        std::vector<double> weights;
+        std::vector<int32_t> firstTarget;  // per source band, -1: no overlap
+        std::vector<int32_t> lastTarget;
+};
+
+class OverlapSpectrumChannel: public SpectrumChannel
+{
+    public:
+        static TypeId GetTypeId(void) {
+            static TypeId tid = TypeId("OverlapSpectrumChannel")
+                .SetParent<SpectrumChannel>()
+                .SetGroupName("Spectrum")
+                .AddConstructor<OverlapSpectrumChannel>();
+            return tid;
+        }
+
+        OverlapSpectrumChannel()
+            : skippedReceivers(0),
+              deliveredReceivers(0),
+              conversions(0)
+        {
+        }
+
+        // called again by a PHY whose spectrum model changed
+        void AddRx(Ptr<SpectrumPhy> phy) override
+        {
+            this->RemoveRx(phy);
+            Ptr<const SpectrumModel> model = phy->GetRxSpectrumModel();
+            NS_ASSERT_MSG(model, "receiver without a spectrum model");
+            this->AddModel(model);
+            this->receivers[model->GetUid()].push_back(phy);
+        }
+
+        void RemoveRx(Ptr<SpectrumPhy> phy) override
+        {
+            for(auto& group : this->receivers)
+            {
+                auto it = std::find(group.second.begin(), group.second.end(), phy);
+                if(it != group.second.end())
+                {
+                    group.second.erase(it);
+                    return;
+                }
+            }
+        }
+
+        std::size_t GetNDevices() const override
+        {
+            std::size_t count = 0;
+            for(const auto& group : this->receivers)
+            {
+                count += group.second.size();
+            }
+            return count;
+        }
+
+        Ptr<NetDevice> GetDevice(std::size_t i) const override
+        {
+            for(const auto& group : this->receivers)
+            {
+                if(i < group.second.size())
+                {
+                    return group.second[i]->GetDevice();
+                }
+                i -= group.second.size();
+            }
+            NS_FATAL_ERROR("device index out of range");
+            return nullptr;
+        }
+
+        uint64_t GetSkippedReceiverCount() const // receivers of a model outside the TX band
+        {
+            return this->skippedReceivers;
+        }
+
+        uint64_t GetDeliveredReceiverCount() const
+        {
+            return this->deliveredReceivers;
+        }
+
+        uint64_t GetConversionCount() const
+        {
+            return this->conversions;
+        }
+
+        uint32_t GetModelCount() const
+        {
+            return this->models.size();
+        }
+
+        void StartTx(Ptr<SpectrumSignalParameters> txParams) override
+        {
+            NS_ASSERT_MSG(txParams->psd, "NULL txPsd");
+            NS_ASSERT_MSG(txParams->txPhy, "NULL txPhy");
+
+            m_txSigParamsTrace(txParams);
+
+            Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility();
+            Ptr<NetDevice> txNetDevice = txParams->txPhy->GetDevice();
+            Ptr<const SpectrumModel> txModel = txParams->psd->GetSpectrumModel();
+            SpectrumModelUid_t txUid = txModel->GetUid();
+            this->AddModel(txModel);
+
+            // occupied bands of the transmission
+            const SpectrumValue& psd = *(txParams->psd);
+            uint32_t bands = psd.GetValuesN();
+            uint32_t first = 0;
+            while(first < bands && psd[first] == 0)
+            {
+                first++;
+            }
+            uint32_t last = bands;
+            while(last > first && psd[last - 1] == 0)
+            {
+                last--;
+            }
+            if(first == last)
+            {
+                return; // no power in any band
+            }
+            last--;
+
+            for(auto& group : this->receivers)
+            {
+                if(group.second.empty())
+                {
+                    continue;
+                }
+
+                Ptr<SpectrumValue> converted;
+                if(group.first == txUid)
+                {
+                    converted = txParams->psd;
+                }
+                else
+                {
+                    converted = this->overlaps[{txUid, group.first}]->Convert(psd, first, last);
+                    if(!converted)
+                    {
+                        this->skippedReceivers += group.second.size();
+                        continue;
+                    }
+                    this->conversions++;
+                }
+
+                for(auto& rxPhy : group.second)
+                {
+                    if(rxPhy == txParams->txPhy)
+                    {
+                        continue;
+                    }
+
+                    Ptr<NetDevice> rxNetDevice = rxPhy->GetDevice();
+                    if(rxNetDevice && txNetDevice && rxNetDevice->GetNode()->GetId() == txNetDevice->GetNode()->GetId())
+                    {
+                        continue; // antennas of the same node, as in MultiModelSpectrumChannel
+                    }
+                    if(m_filter && m_filter->Filter(txParams, rxPhy))
+                    {
+                        continue;
+                    }
+
+                    Ptr<SpectrumSignalParameters> rxParams = txParams->Copy();
+                    rxParams->psd = Copy<SpectrumValue>(converted);
+                    Time delay = MicroSeconds(0);
+
+                    Ptr<MobilityModel> rxMobility = rxPhy->GetMobility();
+                    if(txMobility && rxMobility)
+                    {
+                        double txAntennaGain = 0;
+                        double rxAntennaGain = 0;
+                        double propagationGainDb = 0;
+                        double pathLossDb = 0;
+                        if(rxParams->txAntenna)
+                        {
+                            Angles txAngles(rxMobility->GetPosition(), txMobility->GetPosition());
+                            txAntennaGain = rxParams->txAntenna->GetGainDb(txAngles);
+                            pathLossDb -= txAntennaGain;
+                        }
+                        Ptr<AntennaModel> rxAntenna = DynamicCast<AntennaModel>(rxPhy->GetAntenna());
+                        if(rxAntenna)
+                        {
+                            Angles rxAngles(txMobility->GetPosition(), rxMobility->GetPosition());
+                            rxAntennaGain = rxAntenna->GetGainDb(rxAngles);
+                            pathLossDb -= rxAntennaGain;
+                        }
+                        if(m_propagationLoss)
+                        {
+                            propagationGainDb = m_propagationLoss->CalcRxPower(0, txMobility, rxMobility);
+                            pathLossDb -= propagationGainDb;
+                        }
+                        m_gainTrace(txMobility, rxMobility, txAntennaGain, rxAntennaGain, propagationGainDb, pathLossDb);
+                        m_pathLossTrace(txParams->txPhy, rxPhy, pathLossDb);
+                        if(pathLossDb > m_maxLossDb)
+                        {
+                            continue; // beyond range
+                        }
+                        SpectrumKernels::Scale(*(rxParams->psd), std::pow(10.0, (-pathLossDb) / 10.0));
+
+                        if(m_spectrumPropagationLoss)
+                        {
+                            rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity(rxParams, txMobility, rxMobility);
+                        }
+                        if(m_propagationDelay)
+                        {
+                            delay = m_propagationDelay->GetDelay(txMobility, rxMobility);
+                        }
+                    }
+
+                    this->deliveredReceivers++;
+                    if(rxNetDevice)
+                    {
+                        Simulator::ScheduleWithContext(rxNetDevice->GetNode()->GetId(), delay, &OverlapSpectrumChannel::StartRx, rxParams, rxPhy);
+                    }
+                    else
+                    {
+                        Simulator::Schedule(delay, &OverlapSpectrumChannel::StartRx, rxParams, rxPhy);
+                    }
+                }
+            }
+        }
+
+    protected:
+        void DoDispose() override
+        {
+            this->receivers.clear();
+            this->models.clear();
+            this->overlaps.clear();
+            SpectrumChannel::DoDispose();
+        }
+
+    private:
+        static void StartRx(Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
+        {
+            receiver->StartRx(params);
+        }
+
+        // weights between a new model and every known one, both ways
+        void AddModel(Ptr<const SpectrumModel> model)
+        {
+            SpectrumModelUid_t uid = model->GetUid();
+            if(this->models.count(uid))
+            {
+                return;
+            }
+            for(const auto& known : this->models)
+            {
+                this->overlaps[{uid, known.first}] = Create<SpectrumOverlap>(model, known.second);
+                this->overlaps[{known.first, uid}] = Create<SpectrumOverlap>(known.second, model);
+            }
+            this->models[uid] = model;
+        }
+
+        // ordered by model as in MultiModelSpectrumChannel, so RX events keep their order
+        std::map<SpectrumModelUid_t, std::vector<Ptr<SpectrumPhy>>> receivers;
+        std::map<SpectrumModelUid_t, Ptr<const SpectrumModel>> models;
+        std::map<std::pair<SpectrumModelUid_t, SpectrumModelUid_t>, Ptr<SpectrumOverlap>> overlaps;
+
+        uint64_t skippedReceivers;
+        uint64_t deliveredReceivers;
+        uint64_t conversions;
+};
+
+} // namespace ns3
+
+#endif /* DU_WPAN_MULTIMODEL_H */
@@ -0,0 +1,726 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Building-aware propagation loss for dense urban du-wpan layouts.
+ *
+ * Buildings are axis-aligned boxes with floors and a grid of rooms. The loss
+ * of a link is log-distance plus what the straight path goes through:
+ *
+ *   L = L0 + 10 n log10(d / d0)
+ *       + ExternalWallLoss per building wall     (indoor <-> outdoor)
+ *       + InternalWallLoss per room wall
+ *       + FirstFloorLoss + NextFloorLoss (k - 1)  for k floors, ITU-R P.1238
+ *
+ * Every path is clipped against the buildings near it, which is the costly
+ * part of a large layout. The link table keeps the loss of every pair of
+ * nodes up to CacheMaxLoss in CSR form (row offsets, receivers, loss) and is
+ * written to `<directory>/links-<hash>.bin`, the hash covering the model
+ * parameters, the buildings and the node positions. A later run with the
+ * same layout maps the file instead of computing it. With a table loaded,
+ * pairs of nodes missing from it are out of reach (infinite loss, which the
+ * spectrum channels skip through MaxLossDb); other positions are computed.
+ *
+ * A node that moves (MoveNode()) gets its links recomputed into a row of its
+ * own, which takes precedence over the table; the loss is symmetric, so the
+ * row serves both directions and the table file stays untouched.
+ */
+
+#ifndef DU_WPAN_PROPAGATION_H
+#define DU_WPAN_PROPAGATION_H
+
+#include <ns3/core-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/propagation-module.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "du-wpan-grid.h"
+
+#define LINK_TABLE_MAGIC 0x314b4e4c50575544ULL // "DUWPLNK1"
+
+namespace ns3
+{
+
+class UrbanBuildingPropagationLossModel: public PropagationLossModel
+{
+    public:
+        struct Building
+        {
+            double xMin;
+            double xMax;
+            double yMin;
+            double yMax;
+            uint32_t floors;
+            double floorHeight; // m
+            uint32_t roomsX;
+            uint32_t roomsY;
+        };
+
+        static TypeId GetTypeId(void) {
+            static TypeId tid = TypeId("UrbanBuildingPropagationLossModel")
+                .SetParent<PropagationLossModel>()
+                .SetGroupName("Propagation")
+                .AddConstructor<UrbanBuildingPropagationLossModel>()
+                .AddAttribute("Exponent",
+                              "Path loss exponent",
+                              DoubleValue(3),
+                              MakeDoubleAccessor(&UrbanBuildingPropagationLossModel::exponent),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("ReferenceDistance",
+                              "Distance of the reference loss (m)",
+                              DoubleValue(1),
+                              MakeDoubleAccessor(&UrbanBuildingPropagationLossModel::referenceDistance),
+                              MakeDoubleChecker<double>(0))
+                .AddAttribute("ReferenceLoss",
+                              "Loss at the reference distance (dB), LogDistancePropagationLossModel default",
+                              DoubleValue(46.6777),
+                              MakeDoubleAccessor(&UrbanBuildingPropagationLossModel::referenceLoss),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("ExternalWallLoss",
+                              "Loss of an outer building wall (dB)",
+                              DoubleValue(12),
+                              MakeDoubleAccessor(&UrbanBuildingPropagationLossModel::externalWallLoss),
+                              MakeDoubleChecker<double>(0))
+                .AddAttribute("InternalWallLoss",
+                              "Loss of a wall between rooms (dB)",
+                              DoubleValue(5),
+                              MakeDoubleAccessor(&UrbanBuildingPropagationLossModel::internalWallLoss),
+                              MakeDoubleChecker<double>(0))
+                .AddAttribute("FirstFloorLoss",
+                              "Loss of the first floor crossed (dB)",
+                              DoubleValue(15),
+                              MakeDoubleAccessor(&UrbanBuildingPropagationLossModel::firstFloorLoss),
+                              MakeDoubleChecker<double>(0))
+                .AddAttribute("NextFloorLoss",
+                              "Loss of every further floor crossed (dB)",
+                              DoubleValue(4),
+                              MakeDoubleAccessor(&UrbanBuildingPropagationLossModel::nextFloorLoss),
+                              MakeDoubleChecker<double>(0))
+                .AddAttribute("CacheMaxLoss",
+                              "Links with more loss are left out of the link table (dB)",
+                              DoubleValue(119.2),
+                              MakeDoubleAccessor(&UrbanBuildingPropagationLossModel::maxLoss),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("BuildingGridCell",
+                              "Cell size of the building index (m)",
+                              DoubleValue(50),
+                              MakeDoubleAccessor(&UrbanBuildingPropagationLossModel::buildingCell),
+                              MakeDoubleChecker<double>(1));
+            return tid;
+        }
+
+        UrbanBuildingPropagationLossModel()
+            : exponent(3),
+              referenceDistance(1),
+              referenceLoss(46.6777),
+              externalWallLoss(12),
+              internalWallLoss(5),
+              firstFloorLoss(15),
+              nextFloorLoss(4),
+              maxLoss(119.2),
+              buildingCell(50),
+              mapped(nullptr),
+              mappedSize(0),
+              nodeCount(0),
+              linkCount(0),
+              rowOffsets(nullptr),
+              receivers(nullptr),
+              losses(nullptr),
+              hash(0)
+        {
+        }
+
+        ~UrbanBuildingPropagationLossModel() override
+        {
+            this->Unmap();
+        }
+
+        // the building index is filled here, so every building goes in before the first link
+        void AddBuilding(const Building& building)
+        {
+            NS_ABORT_MSG_IF(building.floors == 0 || building.roomsX == 0 || building.roomsY == 0, "empty building");
+
+            uint32_t id = this->buildings.size();
+            this->buildings.push_back(building);
+            for(int64_t x = this->CellOf(building.xMin); x <= this->CellOf(building.xMax); x++)
+            {
+                for(int64_t y = this->CellOf(building.yMin); y <= this->CellOf(building.yMax); y++)
+                {
+                    this->buildingIndex[CellKey(x, y)].push_back(id);
+                }
+            }
+        }
+
+        uint32_t GetBuildingCount() const
+        {
+            return this->buildings.size();
+        }
+
+        bool IsIndoor(const Vector& position) const
+        {
+            auto cell = this->buildingIndex.find(CellKey(this->CellOf(position.x), this->CellOf(position.y)));
+            if(cell == this->buildingIndex.end())
+            {
+                return false;
+            }
+            for(uint32_t id : cell->second)
+            {
+                if(Inside(this->buildings[id], position))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // loss without the table (dB)
+        double GetLoss(const Vector& a, const Vector& b) const
+        {
+            double distance = CalculateDistance(a, b);
+            double loss = this->referenceLoss;
+            if(distance > this->referenceDistance)
+            {
+                loss += 10 * this->exponent * std::log10(distance / this->referenceDistance);
+            }
+            return loss + this->GetPenetrationLoss(a, b);
+        }
+
+        // distance beyond which even an outdoor link exceeds `loss` (m)
+        double GetRange(double loss) const
+        {
+            return this->referenceDistance * std::pow(10.0, (loss - this->referenceLoss) / (10 * this->exponent));
+        }
+
+        /*
+         * Link table of the nodes at `positions`, in this order. Loaded from
+         * `directory` when a table of the same layout is there, otherwise
+         * computed and written there; an empty `directory` only computes it.
+         * Returns true when the table came from the file.
+         */
+        bool LoadOrBuildLinkTable(const std::vector<Vector>& positions, std::string directory)
+        {
+            this->Unmap();
+            this->table.clear();
+            this->movedLinks.clear();
+            this->hash = this->TopologyHash(positions);
+            this->positions = positions;
+            this->positionIndex.clear();
+            this->nodeGrid.Reset(this->GetRange(this->maxLoss));
+            for(uint32_t i = 0; i < positions.size(); i++)
+            {
+                this->positionIndex.emplace(PositionKey(positions[i]), i);
+                this->nodeGrid.Insert(i, positions[i]);
+            }
+
+            std::string path;
+            if(!directory.empty())
+            {
+                std::ostringstream name;
+                name << directory << "/links-" << std::hex << this->hash << ".bin";
+                path = name.str();
+                if(this->Map(path, positions.size()))
+                {
+                    return true;
+                }
+            }
+
+            this->BuildLinkTable(positions);
+            if(!path.empty())
+            {
+                this->Write(path);
+                if(this->Map(path, positions.size()))
+                {
+                    this->table.clear(); // the mapping holds the same data
+                }
+            }
+            return false;
+        }
+
+        uint64_t GetTopologyHash() const
+        {
+            return this->hash;
+        }
+
+        /*
+         * New position of node `node` of the link table. Its links are
+         * computed against the nodes near the new position, and the rows of
+         * other moved nodes are updated for it.
+         */
+        void MoveNode(uint32_t node, Vector position)
+        {
+            Vector old = this->positions[node];
+            auto key = this->positionIndex.find(PositionKey(old));
+            if(key != this->positionIndex.end() && key->second == node)
+            {
+                this->positionIndex.erase(key);
+            }
+            this->positionIndex[PositionKey(position)] = node;
+            this->nodeGrid.Move(node, old, position);
+            this->positions[node] = position;
+
+            // moved neighbours near the old position lose the old link
+            this->nodeGrid.ForEachNear(old, [&](uint32_t j) {
+                auto row = this->movedLinks.find(j);
+                if(j != node && row != this->movedLinks.end())
+                {
+                    EraseLink(row->second, node);
+                }
+            });
+
+            std::vector<std::pair<uint32_t, float>>& links = this->movedLinks[node];
+            links.clear();
+            this->nodeGrid.ForEachNear(position, [&](uint32_t j) {
+                if(j == node)
+                {
+                    return;
+                }
+                double loss = this->GetLoss(position, this->positions[j]);
+                if(loss > this->maxLoss)
+                {
+                    return;
+                }
+                links.push_back({j, (float) loss});
+
+                auto row = this->movedLinks.find(j);
+                if(row != this->movedLinks.end())
+                {
+                    auto it = std::lower_bound(row->second.begin(), row->second.end(), std::make_pair(node, 0.0f));
+                    row->second.insert(it, {node, (float) loss});
+                }
+            });
+            std::sort(links.begin(), links.end());
+        }
+
+        uint32_t GetMovedNodeCount() const
+        {
+            return this->movedLinks.size();
+        }
+
+        uint64_t GetLinkCount() const
+        {
+            return this->linkCount;
+        }
+
+    protected:
+        void DoDispose() override
+        {
+            this->Unmap();
+            this->table.clear();
+            this->movedLinks.clear();
+            this->positionIndex.clear();
+            PropagationLossModel::DoDispose();
+        }
+
+    private:
+        struct Header
+        {
+            uint64_t magic;
+            uint64_t hash;
+            uint64_t nodes;
+            uint64_t links;
+        };
+
+        struct PositionKey
+        {
+            uint64_t x;
+            uint64_t y;
+            uint64_t z;
+
+            explicit PositionKey(const Vector& v)
+            {
+                std::memcpy(&x, &v.x, sizeof(x));
+                std::memcpy(&y, &v.y, sizeof(y));
+                std::memcpy(&z, &v.z, sizeof(z));
+            }
+
+            bool operator==(const PositionKey& other) const
+            {
+                return x == other.x && y == other.y && z == other.z;
+            }
+        };
+
+        struct PositionHash
+        {
+            size_t operator()(const PositionKey& key) const
+            {
+                return key.x * 0x9e3779b97f4a7c15ULL ^ key.y * 0xc2b2ae3d27d4eb4fULL ^ key.z;
+            }
+        };
+
+        double DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const override
+        {
+            Vector pa = a->GetPosition();
+            Vector pb = b->GetPosition();
+            if(this->rowOffsets)
+            {
+                auto ia = this->positionIndex.find(PositionKey(pa));
+                auto ib = this->positionIndex.find(PositionKey(pb));
+                if(ia != this->positionIndex.end() && ib != this->positionIndex.end())
+                {
+                    return txPowerDbm - this->LookUp(ia->second, ib->second);
+                }
+            }
+            return txPowerDbm - this->GetLoss(pa, pb);
+        }
+
+        int64_t DoAssignStreams(int64_t stream) override
+        {
+            return 0;
+        }
+
+        double LookUp(uint32_t from, uint32_t to) const
+        {
+            // a moved node answers from its own row, the loss is symmetric
+            auto moved = this->movedLinks.find(from);
+            if(moved == this->movedLinks.end() && (moved = this->movedLinks.find(to)) != this->movedLinks.end())
+            {
+                std::swap(from, to);
+            }
+            if(moved != this->movedLinks.end())
+            {
+                auto it = std::lower_bound(moved->second.begin(), moved->second.end(), std::make_pair(to, 0.0f));
+                if(it == moved->second.end() || it->first != to)
+                {
+                    return std::numeric_limits<double>::infinity();
+                }
+                return it->second;
+            }
+
+            const uint32_t* begin = this->receivers + this->rowOffsets[from];
+            const uint32_t* end = this->receivers + this->rowOffsets[from + 1];
+            const uint32_t* it = std::lower_bound(begin, end, to);
+            if(it == end || *it != to)
+            {
+                return std::numeric_limits<double>::infinity();
+            }
+            return this->losses[it - this->receivers];
+        }
+
+        static void EraseLink(std::vector<std::pair<uint32_t, float>>& links, uint32_t node)
+        {
+            auto it = std::lower_bound(links.begin(), links.end(), std::make_pair(node, 0.0f));
+            if(it != links.end() && it->first == node)
+            {
+                links.erase(it);
+            }
+        }
+
+        static bool Inside(const Building& building, const Vector& p)
+        {
+            return p.x >= building.xMin && p.x <= building.xMax && p.y >= building.yMin && p.y <= building.yMax
+                   && p.z >= 0 && p.z <= building.floors * building.floorHeight;
+        }
+
+        double GetPenetrationLoss(const Vector& a, const Vector& b) const
+        {
+            if(this->buildings.empty())
+            {
+                return 0;
+            }
+
+            // buildings in the cells of the bounding box of the path
+            std::vector<uint32_t> candidates;
+            for(int64_t x = this->CellOf(std::min(a.x, b.x)); x <= this->CellOf(std::max(a.x, b.x)); x++)
+            {
+                for(int64_t y = this->CellOf(std::min(a.y, b.y)); y <= this->CellOf(std::max(a.y, b.y)); y++)
+                {
+                    auto cell = this->buildingIndex.find(CellKey(x, y));
+                    if(cell != this->buildingIndex.end())
+                    {
+                        candidates.insert(candidates.end(), cell->second.begin(), cell->second.end());
+                    }
+                }
+            }
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+            double loss = 0;
+            for(uint32_t id : candidates)
+            {
+                loss += this->GetBuildingLoss(this->buildings[id], a, b);
+            }
+            return loss;
+        }
+
+        // walls and floors of one building on the path, the path clipped to the box (Liang-Barsky)
+        double GetBuildingLoss(const Building& building, const Vector& a, const Vector& b) const
+        {
+            double lower[3] = {building.xMin, building.yMin, 0};
+            double upper[3] = {building.xMax, building.yMax, building.floors * building.floorHeight};
+            double from[3] = {a.x, a.y, a.z};
+            double delta[3] = {b.x - a.x, b.y - a.y, b.z - a.z};
+
+            double t0 = 0;
+            double t1 = 1;
+            for(int axis = 0; axis < 3; axis++)
+            {
+                if(delta[axis] == 0)
+                {
+                    if(from[axis] < lower[axis] || from[axis] > upper[axis])
+                    {
+                        return 0;
+                    }
+                    continue;
+                }
+                double ta = (lower[axis] - from[axis]) / delta[axis];
+                double tb = (upper[axis] - from[axis]) / delta[axis];
+                t0 = std::max(t0, std::min(ta, tb));
+                t1 = std::min(t1, std::max(ta, tb));
+            }
+            if(t0 > t1)
+            {
+                return 0;
+            }
+
+            Vector enter(a.x + t0 * delta[0], a.y + t0 * delta[1], a.z + t0 * delta[2]);
+            Vector exit(a.x + t1 * delta[0], a.y + t1 * delta[1], a.z + t1 * delta[2]);
+
+            double loss = 0;
+            loss += (Inside(building, a) ? 0 : this->externalWallLoss) + (Inside(building, b) ? 0 : this->externalWallLoss);
+
+            auto room = [](double v, double low, double high, uint32_t count) {
+                int64_t r = (int64_t) std::floor((v - low) / (high - low) * count);
+                return std::min<int64_t>(std::max<int64_t>(r, 0), count - 1);
+            };
+            int64_t walls = std::abs(room(enter.x, building.xMin, building.xMax, building.roomsX) - room(exit.x, building.xMin, building.xMax, building.roomsX))
+                            + std::abs(room(enter.y, building.yMin, building.yMax, building.roomsY) - room(exit.y, building.yMin, building.yMax, building.roomsY));
+            loss += walls * this->internalWallLoss;
+
+            int64_t floors = std::abs(room(enter.z, 0, upper[2], building.floors) - room(exit.z, 0, upper[2], building.floors));
+            if(floors > 0)
+            {
+                loss += this->firstFloorLoss + (floors - 1) * this->nextFloorLoss;
+            }
+            return loss;
+        }
+
+        int64_t CellOf(double coordinate) const
+        {
+            return (int64_t) std::floor(coordinate / this->buildingCell);
+        }
+
+        static uint64_t CellKey(int64_t x, int64_t y)
+        {
+            return ((uint64_t) (uint32_t) x << 32) | (uint32_t) y;
+        }
+
+        // FNV-1a over everything the table depends on
+        uint64_t TopologyHash(const std::vector<Vector>& positions) const
+        {
+            uint64_t h = 0xcbf29ce484222325ULL;
+            auto mix = [&h](const void* data, size_t size) {
+                const unsigned char* bytes = (const unsigned char*) data;
+                for(size_t i = 0; i < size; i++)
+                {
+                    h = (h ^ bytes[i]) * 0x100000001b3ULL;
+                }
+            };
+
+            uint64_t magic = LINK_TABLE_MAGIC;
+            mix(&magic, sizeof(magic));
+            double parameters[] = {this->exponent, this->referenceDistance, this->referenceLoss, this->externalWallLoss,
+                                   this->internalWallLoss, this->firstFloorLoss, this->nextFloorLoss, this->maxLoss};
+            mix(parameters, sizeof(parameters));
+            for(const Building& building : this->buildings)
+            {
+                double box[] = {building.xMin, building.xMax, building.yMin, building.yMax, building.floorHeight};
+                uint32_t counts[] = {building.floors, building.roomsX, building.roomsY};
+                mix(box, sizeof(box));
+                mix(counts, sizeof(counts));
+            }
+            for(const Vector& position : positions)
+            {
+                double xyz[] = {position.x, position.y, position.z};
+                mix(xyz, sizeof(xyz));
+            }
+            return h;
+        }
+
+        // pairs within the outdoor range through the node grid, rows sorted by receiver
+        void BuildLinkTable(const std::vector<Vector>& positions)
+        {
+            std::vector<uint64_t> offsets(1, 0);
+            std::vector<uint32_t> columns;
+            std::vector<float> values;
+            std::vector<std::pair<uint32_t, float>> row;
+            for(uint32_t i = 0; i < positions.size(); i++)
+            {
+                row.clear();
+                this->nodeGrid.ForEachNear(positions[i], [&](uint32_t j) {
+                    double loss = this->GetLoss(positions[i], positions[j]);
+                    if(j != i && loss <= this->maxLoss)
+                    {
+                        row.push_back({j, (float) loss});
+                    }
+                });
+                std::sort(row.begin(), row.end());
+                for(auto& link : row)
+                {
+                    columns.push_back(link.first);
+                    values.push_back(link.second);
+                }
+                offsets.push_back(columns.size());
+            }
+
+            // one buffer in the layout of the file
+            Header header = {LINK_TABLE_MAGIC, this->hash, positions.size(), columns.size()};
+            this->table.assign(TableSize(header.nodes, header.links), 0);
+            char* data = this->table.data();
+            std::memcpy(data, &header, sizeof(header));
+            std::memcpy(data + sizeof(header), offsets.data(), offsets.size() * sizeof(uint64_t));
+            std::memcpy(data + ReceiversOffset(header.nodes), columns.data(), columns.size() * sizeof(uint32_t));
+            std::memcpy(data + LossesOffset(header.nodes, header.links), values.data(), values.size() * sizeof(float));
+            this->Attach(data, header.nodes, header.links);
+        }
+
+        static size_t ReceiversOffset(uint64_t nodes)
+        {
+            return sizeof(Header) + (nodes + 1) * sizeof(uint64_t);
+        }
+
+        static size_t LossesOffset(uint64_t nodes, uint64_t links)
+        {
+            return ReceiversOffset(nodes) + links * sizeof(uint32_t);
+        }
+
+        static size_t TableSize(uint64_t nodes, uint64_t links)
+        {
+            return LossesOffset(nodes, links) + links * sizeof(float);
+        }
+
+        void Attach(const char* data, uint64_t nodes, uint64_t links)
+        {
+            this->nodeCount = nodes;
+            this->linkCount = links;
+            this->rowOffsets = (const uint64_t*) (data + sizeof(Header));
+            this->receivers = (const uint32_t*) (data + ReceiversOffset(nodes));
+            this->losses = (const float*) (data + LossesOffset(nodes, links));
+        }
+
+        // written next to the target and renamed, concurrent runs never see half a file
+        void Write(const std::string& path) const
+        {
+            std::ostringstream temporary;
+            temporary << path << ".tmp" << getpid();
+            std::ofstream file(temporary.str(), std::ios::binary);
+            file.write(this->table.data(), this->table.size());
+            file.close();
+            if(!file || std::rename(temporary.str().c_str(), path.c_str()) != 0)
+            {
+                std::remove(temporary.str().c_str());
+                NS_LOG_UNCOND("link table: cannot write " << path);
+            }
+        }
+
+        bool Map(const std::string& path, uint64_t nodes)
+        {
+            int fd = open(path.c_str(), O_RDONLY);
+            if(fd < 0)
+            {
+                return false;
+            }
+            struct stat status;
+            void* data = MAP_FAILED;
+            if(fstat(fd, &status) == 0 && (size_t) status.st_size >= sizeof(Header))
+            {
+                data = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            }
+            close(fd);
+            if(data == MAP_FAILED)
+            {
+                return false;
+            }
+
+            const Header* header = (const Header*) data;
+            if(header->magic != LINK_TABLE_MAGIC || header->hash != this->hash || header->nodes != nodes
+               || TableSize(header->nodes, header->links) != (size_t) status.st_size)
+            {
+                munmap(data, status.st_size);
+                return false;
+            }
+            this->mapped = data;
+            this->mappedSize = status.st_size;
+            this->Attach((const char*) data, header->nodes, header->links);
+            return true;
+        }
+
+        void Unmap()
+        {
+            if(this->mapped)
+            {
+                munmap(this->mapped, this->mappedSize);
+            }
+            this->mapped = nullptr;
+            this->mappedSize = 0;
+            this->rowOffsets = nullptr;
+            this->receivers = nullptr;
+            this->losses = nullptr;
+            this->nodeCount = 0;
+            this->linkCount = 0;
+        }
+
+        double exponent;
+        double referenceDistance; // m
+        double referenceLoss;     // dB
+        double externalWallLoss;  // dB
+        double internalWallLoss;  // dB
+        double firstFloorLoss;    // dB
+        double nextFloorLoss;     // dB
+        double maxLoss;           // dB, link table cutoff
+        double buildingCell;      // m
+
+        std::vector<Building> buildings;
+        std::unordered_map<uint64_t, std::vector<uint32_t>> buildingIndex; // cell -> buildings
+
+        // link table, in `table` or in the mapped file
+        std::vector<char> table;
+        void* mapped;
+        size_t mappedSize;
+        uint64_t nodeCount;
+        uint64_t linkCount;
+        const uint64_t* rowOffsets; // nodeCount + 1
+        const uint32_t* receivers;  // linkCount, sorted per row
+        const float* losses;        // linkCount, dB
+        std::unordered_map<PositionKey, uint32_t, PositionHash> positionIndex;
+        uint64_t hash;
+
+        // current positions of the table nodes, rows of the nodes that moved
+        std::vector<Vector> positions;
+        SpatialGrid nodeGrid;
+        std::unordered_map<uint32_t, std::vector<std::pair<uint32_t, float>>> movedLinks;
+};
+
+} // namespace ns3
+
+#endif /* DU_WPAN_PROPAGATION_H */
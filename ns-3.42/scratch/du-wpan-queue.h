@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Application-side transmit queue of an end device.
+ *
+ * The application enqueues every generated packet; the device hands the head
+ * of the queue to the MAC only after the previous MCPS-DATA.confirm, so at most
+ * one frame is inside the MAC at a time and the backlog is visible here. With
+ * aggregation one frame carries several packets (readings) from the head on.
+ *
+ *   enqueue ----(sojourn)----> MCPS-DATA.request ----(service)----> confirm
+ *      |<-------------------- latency, SUCCESS only -------------------->|
+ */
+
+#ifndef DU_WPAN_QUEUE_H
+#define DU_WPAN_QUEUE_H
+
+#include <ns3/core-module.h>
+#include <ns3/network-module.h>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/*
+ * Counters shared by all queues of a run. The total backlog is integrated over
+ * time on every change, so the mean queue length costs O(1) per packet.
+ */
+class QueueStats: public SimpleRefCount<QueueStats>
+{
+    public:
+        QueueStats()
+            : enqueued(0),
+              dropped(0),
+              served(0),
+              completed(0),
+              backlog(0),
+              maxLength(0),
+              delivered(0),
+              latencySquares(0),
+              backlogIntegral(0)
+        {
+        }
+
+        void Changed(int delta)
+        {
+            Time now = Simulator::Now();
+            this->backlogIntegral += (double) this->backlog * (now - this->lastChange).GetSeconds();
+            this->lastChange = now;
+            this->backlog += delta;
+        }
+
+        double GetMeanLatency() const // s
+        {
+            return this->delivered > 0 ? this->latencySum.GetSeconds() / this->delivered : 0;
+        }
+
+        double GetLatencyDeviation() const // s
+        {
+            if(this->delivered == 0)
+            {
+                return 0;
+            }
+            double mean = this->GetMeanLatency();
+            return std::sqrt(std::max(this->latencySquares / this->delivered - mean * mean, 0.0));
+        }
+
+        double GetMeanBacklog() const // packets waiting, summed over all queues
+        {
+            double elapsed = Simulator::Now().GetSeconds();
+            return elapsed > 0 ? this->GetBacklogIntegral() / elapsed : 0;
+        }
+
+        double GetBacklogIntegral() const // packets * s up to now
+        {
+            return this->backlogIntegral + (double) this->backlog * (Simulator::Now() - this->lastChange).GetSeconds();
+        }
+
+        // integral up to now, e.g. summed over the regions of a partitioned run
+        void SetBacklogIntegral(double integral)
+        {
+            this->backlogIntegral = integral;
+            this->lastChange = Simulator::Now();
+        }
+
+        uint64_t enqueued;  // accepted into a queue
+        uint64_t dropped;   // rejected or pushed out by the drop policy
+        uint64_t served;    // packets handed to the MAC
+        uint64_t completed; // frames confirmed by the MAC
+        uint64_t backlog;   // currently waiting
+        uint32_t maxLength; // longest single queue seen
+
+        Time sojournSum; // enqueue -> MCPS-DATA.request
+        Time sojournMax;
+        Time serviceSum; // MCPS-DATA.request -> MCPS-DATA.confirm
+        Time serviceMax;
+
+        uint64_t delivered;    // packets confirmed with SUCCESS
+        Time latencySum;       // enqueue -> MCPS-DATA.confirm SUCCESS
+        Time latencyMax;
+        double latencySquares; // s^2
+
+    private:
+        double backlogIntegral;
+        Time lastChange;
+};
+
+class DeviceTxQueue: public SimpleRefCount<DeviceTxQueue>
+{
+    public:
+        enum DropPolicy
+        {
+            DROP_TAIL, // reject the arriving packet
+            DROP_HEAD  // discard the oldest packet, keep the fresh one
+        };
+
+        static DropPolicy ParseDropPolicy(std::string name)
+        {
+            if(name == "head")
+            {
+                return DROP_HEAD;
+            }
+            NS_ABORT_MSG_IF(name != "tail", "unknown drop policy: " << name);
+            return DROP_TAIL;
+        }
+
+        DeviceTxQueue(uint32_t capacity, DropPolicy policy, Ptr<QueueStats> stats)
+            : capacity(capacity),
+              policy(policy),
+              stats(stats),
+              inService(false)
+        {
+        }
+
+        // returns false if the packet was dropped
+        bool Enqueue(Ptr<Packet> packet)
+        {
+            if(this->capacity > 0 && this->queue.size() >= this->capacity)
+            {
+                this->stats->dropped++;
+                if(this->policy == DROP_TAIL)
+                {
+                    return false;
+                }
+                this->queue.pop_front();
+                this->stats->Changed(-1);
+            }
+
+            this->queue.push_back({packet, Simulator::Now()});
+            this->stats->enqueued++;
+            this->stats->Changed(1);
+            this->stats->maxLength = std::max<uint32_t>(this->stats->maxLength, this->queue.size());
+            return true;
+        }
+
+        // head of the queue can be handed to the MAC
+        bool IsReady() const
+        {
+            return !this->inService && !this->queue.empty();
+        }
+
+        uint32_t GetLength() const
+        {
+            return this->queue.size();
+        }
+
+        // enqueue time of the head of the queue
+        Time GetHeadEnqueueTime() const
+        {
+            return this->queue.front().enqueued;
+        }
+
+        // up to `count` packets from the head, all of them in service as one frame
+        std::vector<Ptr<Packet>> Dequeue(uint32_t count)
+        {
+            Time now = Simulator::Now();
+            std::vector<Ptr<Packet>> packets;
+            this->serviceEnqueued.clear();
+            while(packets.size() < count && !this->queue.empty())
+            {
+                Entry entry = this->queue.front();
+                this->queue.pop_front();
+                this->stats->Changed(-1);
+
+                Time sojourn = now - entry.enqueued;
+                this->stats->served++;
+                this->stats->sojournSum += sojourn;
+                this->stats->sojournMax = Max(this->stats->sojournMax, sojourn);
+
+                packets.push_back(entry.packet);
+                this->serviceEnqueued.push_back(entry.enqueued);
+            }
+
+            this->inService = true;
+            this->serviceStart = now;
+            return packets;
+        }
+
+        // MCPS-DATA.confirm for the frame in service
+        void Complete(bool success)
+        {
+            if(!this->inService)
+            {
+                return;
+            }
+            Time service = Simulator::Now() - this->serviceStart;
+            this->stats->completed++;
+            this->stats->serviceSum += service;
+            this->stats->serviceMax = Max(this->stats->serviceMax, service);
+            this->inService = false;
+
+            if(success)
+            {
+                for(Time enqueued : this->serviceEnqueued)
+                {
+                    Time latency = Simulator::Now() - enqueued;
+                    this->stats->delivered++;
+                    this->stats->latencySum += latency;
+                    this->stats->latencyMax = Max(this->stats->latencyMax, latency);
+                    this->stats->latencySquares += latency.GetSeconds() * latency.GetSeconds();
+                }
+            }
+        }
+
+    private:
+        struct Entry
+        {
+            Ptr<Packet> packet;
+            Time enqueued;
+        };
+
+        uint32_t capacity; // 0: unbounded
+        DropPolicy policy;
+        Ptr<QueueStats> stats;
+
+        std::deque<Entry> queue;
+        bool inService;
+        Time serviceStart;
+        std::vector<Time> serviceEnqueued; // every packet of the frame in service
+};
+
+} // namespace ns3
+
+#endif /* DU_WPAN_QUEUE_H */
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Content-addressed store of simulation results.
+ *
+ * The key is an FNV-1a hash over the run description (every parameter, the
+ * compile-time constants, the RNG seed and run) and the binary: the contents
+ * of the executable and the size and modification time of every ns-3 library
+ * it has mapped. A rebuild that changes the model changes the key; the same
+ * sweep point of another study finds the stored result.
+ *
+ *   <directory>/<key>.out      output of a finished run
+ *   <directory>/<key>.partial  output up to the last checkpoint of an unfinished run
+ *   <directory>/index.tsv      key, finish time, output bytes, description
+ *
+ * Files are written next to their target and renamed, so concurrent runs of
+ * a sweep never read half an entry.
+ */
+
+#ifndef DU_WPAN_RESULTS_H
+#define DU_WPAN_RESULTS_H
+
+#include <ns3/core-module.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <streambuf>
+#include <string>
+
+namespace ns3
+{
+
+class ResultStore: public SimpleRefCount<ResultStore>
+{
+    public:
+        ResultStore(std::string directory, std::string description)
+            : directory(directory),
+              description(description),
+              stream(nullptr),
+              original(nullptr),
+              tee(nullptr, &this->captured)
+        {
+            NS_ABORT_MSG_IF(mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST,
+                            "result cache: cannot create " << directory);
+            uint64_t h = Hash(description.data(), description.size());
+            uint64_t binary = HashBinary();
+            this->key = Hash(&binary, sizeof(binary), h);
+        }
+
+        ~ResultStore()
+        {
+            this->Release();
+        }
+
+        uint64_t GetKey() const
+        {
+            return this->key;
+        }
+
+        // writes the stored output of a finished run with this key to `out`
+        bool Replay(std::ostream& out) const
+        {
+            std::ifstream file(this->PathOf(".out"), std::ios::binary);
+            if(!file)
+            {
+                return false;
+            }
+            out << file.rdbuf();
+            out.flush();
+            return true;
+        }
+
+        // keeps a copy of everything written to `out` from here on
+        void Capture(std::ostream& out)
+        {
+            this->Release();
+            this->stream = &out;
+            this->original = out.rdbuf();
+            this->tee.SetTarget(this->original);
+            out.rdbuf(&this->tee);
+        }
+
+        // interim statistics survive a run that does not finish
+        void Checkpoint()
+        {
+            this->stream->flush();
+            this->Write(this->PathOf(".partial"), this->captured.str());
+        }
+
+        void Commit()
+        {
+            this->stream->flush();
+            if(!this->Write(this->PathOf(".out"), this->captured.str()))
+            {
+                return;
+            }
+            std::remove(this->PathOf(".partial").c_str());
+
+            std::string line = this->description;
+            for(char& c : line)
+            {
+                if(c == '\t' || c == '\n')
+                {
+                    c = ' ';
+                }
+            }
+            std::ofstream index(this->directory + "/index.tsv", std::ios::app);
+            index << std::hex << this->key << std::dec << "\t" << std::time(nullptr) << "\t" << this->captured.str().size()
+                  << "\t" << line << "\n";
+        }
+
+    private:
+        // writes to the original buffer and the capture
+        class TeeBuffer: public std::streambuf
+        {
+            public:
+                TeeBuffer(std::streambuf* target, std::stringbuf* copy)
+                    : target(target),
+                      copy(copy)
+                {
+                }
+
+                void SetTarget(std::streambuf* target)
+                {
+                    this->target = target;
+                }
+
+            protected:
+                int overflow(int c) override
+                {
+                    if(c == EOF)
+                    {
+                        return !EOF;
+                    }
+                    this->copy->sputc((char) c);
+                    return this->target->sputc((char) c);
+                }
+
+                std::streamsize xsputn(const char* s, std::streamsize n) override
+                {
+                    this->copy->sputn(s, n);
+                    return this->target->sputn(s, n);
+                }
+
+                int sync() override
+                {
+                    return this->target->pubsync();
+                }
+
+            private:
+                std::streambuf* target;
+                std::stringbuf* copy;
+        };
+
+        static uint64_t Hash(const void* data, size_t size, uint64_t h = 0xcbf29ce484222325ULL)
+        {
+            const unsigned char* bytes = (const unsigned char*) data;
+            for(size_t i = 0; i < size; i++)
+            {
+                h = (h ^ bytes[i]) * 0x100000001b3ULL;
+            }
+            return h;
+        }
+
+        // executable by contents, ns-3 libraries by size and modification time
+        static uint64_t HashBinary()
+        {
+            uint64_t h = 0xcbf29ce484222325ULL;
+            std::ifstream exe("/proc/self/exe", std::ios::binary);
+            char buffer[1 << 16];
+            while(exe.read(buffer, sizeof(buffer)) || exe.gcount() > 0)
+            {
+                h = Hash(buffer, exe.gcount(), h);
+            }
+
+            std::set<std::string> libraries;
+            std::ifstream maps("/proc/self/maps");
+            std::string line;
+            while(std::getline(maps, line))
+            {
+                size_t path = line.find('/');
+                if(path != std::string::npos && line.find("libns3", path) != std::string::npos)
+                {
+                    libraries.insert(line.substr(path));
+                }
+            }
+            for(const std::string& library : libraries)
+            {
+                struct stat status;
+                if(stat(library.c_str(), &status) != 0)
+                {
+                    continue;
+                }
+                int64_t metadata[] = {(int64_t) status.st_size, (int64_t) status.st_mtime};
+                h = Hash(library.data(), library.size(), h);
+                h = Hash(metadata, sizeof(metadata), h);
+            }
+            return h;
+        }
+
+        std::string PathOf(const char* suffix) const
+        {
+            std::ostringstream path;
+            path << this->directory << "/" << std::hex << this->key << suffix;
+            return path.str();
+        }
+
+        bool Write(const std::string& path, const std::string& contents) const
+        {
+            std::ostringstream temporary;
+            temporary << path << ".tmp" << getpid();
+            std::ofstream file(temporary.str(), std::ios::binary);
+            file << contents;
+            file.close();
+            if(!file || std::rename(temporary.str().c_str(), path.c_str()) != 0)
+            {
+                std::remove(temporary.str().c_str());
+                std::cerr << "result cache: cannot write " << path << std::endl;
+                return false;
+            }
+            return true;
+        }
+
+        // gives the stream its own buffer back
+        void Release()
+        {
+            if(this->stream)
+            {
+                this->stream->flush();
+                this->stream->rdbuf(this->original);
+                this->stream = nullptr;
+            }
+        }
+
+        std::string directory;
+        std::string description;
+        uint64_t key;
+        std::ostream* stream;
+        std::streambuf* original;
+        std::stringbuf captured;
+        TeeBuffer tee;
+};
+
+} // namespace ns3
+
+#endif /* DU_WPAN_RESULTS_H */
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * SIMD kernel for the PSD scaling of the spectrum channels.
+ *
+ * ParallelSpectrumChannel (du-wpan-channel.h) and OverlapSpectrumChannel
+ * (du-wpan-multimodel.h) copy the PSD of a transmission for every receiver
+ * and multiply it by the path gain, psd *= gain. The values of a
+ * SpectrumValue are one contiguous std::vector<double>, so this is a loop
+ * over a double array. It has a scalar, an SSE2 and an AVX2 version; the
+ * widest one the CPU supports is picked once at first use (GCC/Clang on x86,
+ * scalar elsewhere). Every lane does one multiplication, so the result has
+ * the same bits as SpectrumValue::operator*=.
+ *
+ * The per-band loops of LrWpanPhy and LrWpanInterferenceHelper are inside the
+ * ns-3 modules and keep the SpectrumValue operators.
+ */
+
+#ifndef DU_WPAN_SPECTRUM_KERNELS_H
+#define DU_WPAN_SPECTRUM_KERNELS_H
+
+#include <ns3/core-module.h>
+#include <ns3/spectrum-module.h>
+
+#include <cstddef>
+#include <string>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define DU_WPAN_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace ns3
+{
+
+class SpectrumKernels
+{
+    public:
+        enum Isa
+        {
+            ISA_SCALAR = 0,
+            ISA_SSE2,
+            ISA_AVX2
+        };
+
+        struct Table
+        {
+            void (*scale)(double* x, std::size_t n, double k);
+        };
+
+        static Isa GetBestIsa()
+        {
+#ifdef DU_WPAN_SIMD_X86
+            __builtin_cpu_init();
+            if(__builtin_cpu_supports("avx2"))
+            {
+                return ISA_AVX2;
+            }
+            if(__builtin_cpu_supports("sse2"))
+            {
+                return ISA_SSE2;
+            }
+#endif
+            return ISA_SCALAR;
+        }
+
+        static std::string GetIsaName(Isa isa)
+        {
+            switch(isa)
+            {
+                case ISA_AVX2:
+                    return "avx2";
+                case ISA_SSE2:
+                    return "sse2";
+                default:
+                    return "scalar";
+            }
+        }
+
+        // kernel of one instruction set, falls back to scalar if not compiled in
+        static const Table& GetTable(Isa isa)
+        {
+            static const Table scalar = {ScalarScale};
+#ifdef DU_WPAN_SIMD_X86
+            static const Table sse2 = {Sse2Scale};
+            static const Table avx2 = {Avx2Scale};
+            if(isa == ISA_AVX2)
+            {
+                return avx2;
+            }
+            if(isa == ISA_SSE2)
+            {
+                return sse2;
+            }
+#endif
+            return scalar;
+        }
+
+        // kernel in use, best supported instruction set unless overridden by SetIsa()
+        static const Table*& Active()
+        {
+            static const Table* table = &GetTable(GetBestIsa());
+            return table;
+        }
+
+        static void SetIsa(Isa isa)
+        {
+            Active() = &GetTable(isa);
+        }
+
+        static void Scale(double* x, std::size_t n, double k) { Active()->scale(x, n, k); }
+
+        static void Scale(SpectrumValue& x, double k)
+        {
+            Scale(Data(x), x.GetValuesN(), k);
+        }
+
+    private:
+        static double* Data(SpectrumValue& x)
+        {
+            return x.GetValuesN() > 0 ? &*x.ValuesBegin() : nullptr;
+        }
+
+        // scalar
+        static void ScalarScale(double* x, std::size_t n, double k)
+        {
+            for(std::size_t i = 0; i < n; i++) x[i] *= k;
+        }
+
+#ifdef DU_WPAN_SIMD_X86
+        // SSE2, 2 doubles per register
+        __attribute__((target("sse2"))) static void Sse2Scale(double* x, std::size_t n, double k)
+        {
+            __m128d vk = _mm_set1_pd(k);
+            std::size_t i = 0;
+            for(; i + 2 <= n; i += 2) _mm_storeu_pd(x + i, _mm_mul_pd(_mm_loadu_pd(x + i), vk));
+            for(; i < n; i++) x[i] *= k;
+        }
+
+        // AVX2, 4 doubles per register
+        __attribute__((target("avx2"))) static void Avx2Scale(double* x, std::size_t n, double k)
+        {
+            __m256d vk = _mm256_set1_pd(k);
+            std::size_t i = 0;
+            for(; i + 4 <= n; i += 4) _mm256_storeu_pd(x + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), vk));
+            for(; i < n; i++) x[i] *= k;
+        }
+#endif
+};
+
+} // namespace ns3
+
+#endif /* DU_WPAN_SPECTRUM_KERNELS_H */
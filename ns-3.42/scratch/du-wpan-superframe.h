@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Superframe and GTS layout of a beacon-enabled du-wpan PAN.
+ *
+ *   |beacon|        CAP        |  GTS n  | ... |  GTS 1  |    inactive    |
+ *   |<------------ SD = 960 * 2^SO symbols ------------->|
+ *   |<------------------------ BI = 960 * 2^BO symbols ------------------>|
+ *
+ * The 16 slots of the active portion keep at least aMinCAPLength for the CAP
+ * and give the rest to at most 7 GTS descriptors, allocated from the end of
+ * the superframe like the CFP of IEEE 802.15.4. A GTS is as many slots as one
+ * transaction (CSMA alignment, frame, ACK, IFS) needs. With more members than
+ * descriptors, the members take the descriptors in turns over consecutive
+ * superframes.
+ *
+ * PANs are kept apart in time: the beacon of PAN i starts at (i mod 2^(BO-SO))
+ * SD, so up to 2^(BO-SO) PANs have disjoint active portions.
+ */
+
+#ifndef DU_WPAN_SUPERFRAME_H
+#define DU_WPAN_SUPERFRAME_H
+
+#include <ns3/core-module.h>
+
+#include <algorithm>
+#include <cmath>
+
+#define LRWPAN_SYMBOL_DURATION 16          // us, O-QPSK 2.4 GHz
+#define LRWPAN_BASE_SUPERFRAME_DURATION 960 // symbols, aBaseSuperframeDuration
+#define LRWPAN_SUPERFRAME_SLOTS 16          // aNumSuperframeSlots
+#define LRWPAN_MIN_CAP_LENGTH 440           // symbols, aMinCAPLength
+#define LRWPAN_MAX_GTS 7                    // GTS descriptors per superframe
+#define LRWPAN_MAX_BEACON_ORDER 14
+
+namespace ns3
+{
+
+class GtsSchedule: public SimpleRefCount<GtsSchedule>
+{
+    public:
+        // smallest beacon order that gives `offsets` PANs their own active portion
+        static uint32_t GetAutoBeaconOrder(uint32_t superframeOrder, uint32_t offsets)
+        {
+            uint32_t beaconOrder = superframeOrder;
+            while((1u << (beaconOrder - superframeOrder)) < offsets && beaconOrder < LRWPAN_MAX_BEACON_ORDER)
+            {
+                beaconOrder++;
+            }
+            return beaconOrder;
+        }
+
+        GtsSchedule(uint32_t beaconOrder, uint32_t superframeOrder, uint32_t members, Time transaction)
+            : beaconOrder(beaconOrder),
+              superframeOrder(superframeOrder),
+              members(members)
+        {
+            NS_ABORT_MSG_IF(superframeOrder > beaconOrder || beaconOrder > LRWPAN_MAX_BEACON_ORDER,
+                            "invalid superframe: BO " << beaconOrder << ", SO " << superframeOrder);
+
+            uint64_t slotSymbols = (uint64_t) LRWPAN_BASE_SUPERFRAME_DURATION / LRWPAN_SUPERFRAME_SLOTS << superframeOrder;
+            uint32_t minCapSlots = (uint32_t) ((LRWPAN_MIN_CAP_LENGTH + slotSymbols - 1) / slotSymbols);
+            this->slotsPerGts = (uint32_t) std::ceil(transaction.GetSeconds() / this->GetSlotDuration().GetSeconds());
+            this->descriptors = std::min<uint32_t>({LRWPAN_MAX_GTS, members, (LRWPAN_SUPERFRAME_SLOTS - minCapSlots) / this->slotsPerGts});
+            NS_ABORT_MSG_IF(members > 0 && this->descriptors == 0,
+                            "SO " << superframeOrder << " has no room for a GTS of " << transaction.As(Time::MS));
+            this->round = members > 0 ? (members + this->descriptors - 1) / this->descriptors : 1;
+        }
+
+        Time GetBeaconInterval() const
+        {
+            return MicroSeconds((uint64_t) LRWPAN_BASE_SUPERFRAME_DURATION * LRWPAN_SYMBOL_DURATION << this->beaconOrder);
+        }
+
+        Time GetSuperframeDuration() const
+        {
+            return MicroSeconds((uint64_t) LRWPAN_BASE_SUPERFRAME_DURATION * LRWPAN_SYMBOL_DURATION << this->superframeOrder);
+        }
+
+        Time GetSlotDuration() const
+        {
+            return this->GetSuperframeDuration() / LRWPAN_SUPERFRAME_SLOTS;
+        }
+
+        uint32_t GetBeaconOrder() const
+        {
+            return this->beaconOrder;
+        }
+
+        uint32_t GetSuperframeOrder() const
+        {
+            return this->superframeOrder;
+        }
+
+        uint32_t GetOffsetCount() const
+        {
+            return 1u << (this->beaconOrder - this->superframeOrder);
+        }
+
+        // start of the first superframe of PAN `panId`
+        Time GetOffset(uint32_t panId) const
+        {
+            return this->GetSuperframeDuration() * (int64_t) (panId % this->GetOffsetCount());
+        }
+
+        uint32_t GetSlotsPerGts() const
+        {
+            return this->slotsPerGts;
+        }
+
+        uint32_t GetDescriptorCount() const
+        {
+            return this->descriptors;
+        }
+
+        uint32_t GetRoundLength() const // superframes until every member had a GTS
+        {
+            return this->round;
+        }
+
+        uint32_t GetFinalCapSlot() const
+        {
+            return LRWPAN_SUPERFRAME_SLOTS - 1 - this->descriptors * this->slotsPerGts;
+        }
+
+        // GTS of member `member` (0-based) in superframe `superframe`, relative to its beacon
+        bool GetGts(uint32_t member, uint64_t superframe, Time& start, Time& length) const
+        {
+            if(member >= this->members || member / this->descriptors != superframe % this->round)
+            {
+                return false;
+            }
+            uint32_t descriptor = member % this->descriptors;
+            start = this->GetSlotDuration() * (int64_t) (LRWPAN_SUPERFRAME_SLOTS - (descriptor + 1) * this->slotsPerGts);
+            length = this->GetSlotDuration() * (int64_t) this->slotsPerGts;
+            return true;
+        }
+
+    private:
+        uint32_t beaconOrder;
+        uint32_t superframeOrder;
+        uint32_t members;
+        uint32_t slotsPerGts;
+        uint32_t descriptors;
+        uint32_t round;
+};
+
+} // namespace ns3
+
+#endif /* DU_WPAN_SUPERFRAME_H */
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Progress of a long run, one line of key=value pairs per report:
+ *
+ *   progress time=1718000000 wall=120.0 sim=42.3 rate=0.35 eta=731 pending=81234
+ *            events=5120000 eps=42667 rss_mb=812.4 pdr=0.913 backlog=1532
+ *
+ *   time     wall clock of the report (s since the epoch), a stale value means a stalled job
+ *   wall     wall clock since Start() (s)
+ *   sim      simulated time (s)
+ *   rate     simulated seconds per wall second since the last report
+ *   eta      wall seconds left until the stop time at that rate
+ *   pending  events in the scheduler (CountingScheduler, cancelled ones included),
+ *            na when --SchedulerType is not the default MapScheduler
+ *   events   events executed, eps per wall second since the last report
+ *   rss_mb   resident set of the process (/proc/self/statm)
+ *   ...      fields added with AddField()
+ *
+ * The wall clock is only read by a check event every Step of simulated time.
+ * The step adapts so that about ten checks fall into one report interval,
+ * whatever the event density is; nothing is done per event.
+ *
+ * Lines go to stdout, or replace the contents of a status file, so that
+ * `cat` shows the last report. Neither is part of the result cache capture.
+ */
+
+#ifndef DU_WPAN_TELEMETRY_H
+#define DU_WPAN_TELEMETRY_H
+
+#include <ns3/core-module.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+// MapScheduler (the default) that keeps its size
+class CountingScheduler: public MapScheduler
+{
+    public:
+        static TypeId GetTypeId(void) {
+            static TypeId tid = TypeId("CountingScheduler")
+                .SetParent<MapScheduler>()
+                .SetGroupName("Core")
+                .AddConstructor<CountingScheduler>();
+            return tid;
+        }
+
+        void Insert(const Scheduler::Event& ev) override
+        {
+            MapScheduler::Insert(ev);
+            Pending()++;
+        }
+
+        Scheduler::Event RemoveNext() override
+        {
+            Pending()--;
+            return MapScheduler::RemoveNext();
+        }
+
+        void Remove(const Scheduler::Event& ev) override
+        {
+            Pending()--;
+            MapScheduler::Remove(ev);
+        }
+
+        static uint64_t GetPendingCount()
+        {
+            return Pending();
+        }
+
+    private:
+        static uint64_t& Pending() // one simulator per process
+        {
+            static uint64_t pending = 0;
+            return pending;
+        }
+};
+
+class ProgressMonitor: public Object
+{
+    public:
+        static TypeId GetTypeId(void) {
+            static TypeId tid = TypeId("ProgressMonitor")
+                .SetParent<Object>()
+                .SetGroupName("Stats")
+                .AddConstructor<ProgressMonitor>()
+                .AddAttribute("Interval",
+                              "Wall clock seconds between two reports",
+                              DoubleValue(30),
+                              MakeDoubleAccessor(&ProgressMonitor::interval),
+                              MakeDoubleChecker<double>(0))
+                .AddAttribute("Step",
+                              "Simulated time between the first two wall clock checks",
+                              TimeValue(MilliSeconds(100)),
+                              MakeTimeAccessor(&ProgressMonitor::step),
+                              MakeTimeChecker());
+            return tid;
+        }
+
+        ProgressMonitor()
+            : interval(30),
+              step(MilliSeconds(100)),
+              counting(false),
+              lastSim(0),
+              lastEvents(0)
+        {
+        }
+
+        // the scheduler has to be in place before the first event is scheduled;
+        // only replaces MapScheduler, another --SchedulerType is kept and pending= is not reported
+        void InstallCountingScheduler()
+        {
+            TypeIdValue scheduler;
+            GlobalValue::GetValueByName("SchedulerType", scheduler);
+            if(scheduler.Get() != MapScheduler::GetTypeId())
+            {
+                std::cerr << "progress: scheduler " << scheduler.Get().GetName()
+                          << " kept, pending events are not reported" << std::endl;
+                return;
+            }
+            ObjectFactory factory;
+            factory.SetTypeId(CountingScheduler::GetTypeId());
+            Simulator::SetScheduler(factory);
+            this->counting = true;
+        }
+
+        void SetStopTime(Time stop)
+        {
+            this->stop = stop;
+        }
+
+        // empty: stdout
+        void SetStatusFile(std::string path)
+        {
+            this->path = path;
+        }
+
+        // extra value in every report, e.g. the delivery ratio
+        void AddField(std::string name, Callback<double> value)
+        {
+            this->fields.push_back({name, value});
+        }
+
+        void Start()
+        {
+            this->start = std::chrono::steady_clock::now();
+            this->last = this->start;
+            this->lastCheck = this->start;
+            this->lastSim = Simulator::Now().GetSeconds();
+            this->lastEvents = Simulator::GetEventCount();
+            this->checkEvent = Simulator::Schedule(this->step, &ProgressMonitor::Check, this);
+        }
+
+        // one last report, e.g. after Simulator::Run()
+        void Report()
+        {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            double elapsed = std::chrono::duration<double>(now - this->last).count();
+            double sim = Simulator::Now().GetSeconds();
+            uint64_t events = Simulator::GetEventCount();
+            double rate = elapsed > 0 ? (sim - this->lastSim) / elapsed : 0;
+
+            std::ostringstream line;
+            line << "progress time=" << std::time(nullptr)
+                 << " wall=" << std::chrono::duration<double>(now - this->start).count()
+                 << " sim=" << sim
+                 << " rate=" << rate
+                 << " eta=";
+            if(rate > 0)
+            {
+                line << std::max((this->stop.GetSeconds() - sim) / rate, 0.0);
+            }
+            else
+            {
+                line << "inf";
+            }
+            line << " pending=";
+            if(this->counting)
+            {
+                line << CountingScheduler::GetPendingCount();
+            }
+            else
+            {
+                line << "na";
+            }
+            line << " events=" << events
+                 << " eps=" << (elapsed > 0 ? (events - this->lastEvents) / elapsed : 0)
+                 << " rss_mb=" << ResidentMegabytes();
+            for(Field& field : this->fields)
+            {
+                line << " " << field.name << "=" << field.value();
+            }
+            this->Write(line.str());
+
+            this->last = now;
+            this->lastSim = sim;
+            this->lastEvents = events;
+        }
+
+    protected:
+        void DoDispose() override
+        {
+            this->checkEvent.Cancel();
+            this->fields.clear();
+            Object::DoDispose();
+        }
+
+    private:
+        struct Field
+        {
+            std::string name;
+            Callback<double> value;
+        };
+
+        void Check()
+        {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            double sinceCheck = std::chrono::duration<double>(now - this->lastCheck).count();
+            this->lastCheck = now;
+
+            // about ten checks per report, within 1 us and 10 s of simulated time
+            double target = this->interval / 10;
+            double scale = sinceCheck > 0 ? target / sinceCheck : 2.0;
+            scale = std::min(std::max(scale, 0.5), 2.0);
+            this->step = Min(Max(this->step * scale, MicroSeconds(1)), Seconds(10));
+
+            if(std::chrono::duration<double>(now - this->last).count() >= this->interval)
+            {
+                this->Report();
+            }
+            this->checkEvent = Simulator::Schedule(this->step, &ProgressMonitor::Check, this);
+        }
+
+        static double ResidentMegabytes()
+        {
+            std::ifstream statm("/proc/self/statm");
+            uint64_t size = 0;
+            uint64_t resident = 0;
+            statm >> size >> resident;
+            return resident * (double) sysconf(_SC_PAGESIZE) / (1 << 20);
+        }
+
+        void Write(const std::string& line) const
+        {
+            if(this->path.empty())
+            {
+                std::cout << line << std::endl;
+                return;
+            }
+            std::string temporary = this->path + ".tmp";
+            std::ofstream file(temporary);
+            file << line << "\n";
+            file.close();
+            if(!file || std::rename(temporary.c_str(), this->path.c_str()) != 0)
+            {
+                std::cerr << "progress: cannot write " << this->path << std::endl;
+            }
+        }
+
+        double interval; // s, wall clock
+        Time step;
+        bool counting; // CountingScheduler installed
+        Time stop;
+        std::string path;
+        std::vector<Field> fields;
+
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point last;      // last report
+        std::chrono::steady_clock::time_point lastCheck;
+        double lastSim;
+        uint64_t lastEvents;
+        EventId checkEvent;
+};
+
+} // namespace ns3
+
+#endif /* DU_WPAN_TELEMETRY_H */
@@ -0,0 +1,561 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Stochastic traffic models for the DU-WPAN scenario.
+ *
+ * Every PAN owns one generator. Arrivals of all end devices of the PAN are
+ * generated a block at a time (Refill) and kept sorted; only the earliest
+ * arrival of the block is scheduled, so each PAN has exactly one pending
+ * traffic event no matter how many packets are in flight.
+ *
+ *  - PoissonTrafficGenerator: superposition of per-device Poisson processes
+ *  - OnOffTrafficGenerator:   per-device exponential on/off bursts
+ *  - EventTrafficGenerator:   bursts driven by a SharedEventProcess, so that
+ *                             neighbouring PANs report the same event together
+ */
+
+#ifndef DU_WPAN_TRAFFIC_H
+#define DU_WPAN_TRAFFIC_H
+
+#include <ns3/core-module.h>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <iterator>
+#include <vector>
+
+namespace ns3
+{
+
+struct TrafficArrival
+{
+    Time time;
+    uint32_t device; // end device index inside the PAN, 1..N
+};
+
+inline bool
+operator<(const TrafficArrival& a, const TrafficArrival& b)
+{
+    return a.time < b.time;
+}
+
+class PanTrafficGenerator: public Object
+{
+    public:
+        typedef Callback<void, uint32_t> ArrivalCallback;
+
+        static TypeId GetTypeId(void) {
+            static TypeId tid = TypeId("PanTrafficGenerator")
+                .SetParent<Object>()
+                .SetGroupName("Network");
+            return tid;
+        }
+
+        PanTrafficGenerator()
+            : deviceCount(0),
+              batchSize(64),
+              running(false)
+        {
+        }
+
+        void SetArrivalCallback(ArrivalCallback callback)
+        {
+            this->arrival = callback;
+        }
+
+        void SetDeviceCount(uint32_t count) // end devices only, coordinator excluded
+        {
+            this->deviceCount = count;
+        }
+
+        void SetBatchSize(uint32_t size) // arrivals generated per refill
+        {
+            this->batchSize = std::max<uint32_t>(size, 1);
+        }
+
+        virtual void Start()
+        {
+            this->running = true;
+            this->horizon = Simulator::Now();
+            this->Fill();
+            this->ScheduleNext();
+        }
+
+        void Stop()
+        {
+            this->running = false;
+            this->nextEvent.Cancel();
+        }
+
+        // merge arrivals produced outside of Refill(), e.g. by a shared event process
+        void AddArrivals(std::vector<TrafficArrival> arrivals)
+        {
+            if(!this->running)
+            {
+                return; // never started (PAN of another region) or stopped
+            }
+            std::sort(arrivals.begin(), arrivals.end());
+
+            std::deque<TrafficArrival> merged;
+            std::merge(this->block.begin(), this->block.end(), arrivals.begin(), arrivals.end(), std::back_inserter(merged));
+            this->block.swap(merged);
+
+            if(!this->block.empty() && (this->nextEvent.IsExpired() || this->block.front().time < this->nextTime))
+            {
+                this->nextEvent.Cancel();
+                this->ScheduleNext();
+            }
+        }
+
+        virtual int64_t AssignStreams(int64_t stream) = 0;
+
+    protected:
+        // append the next block of arrivals (in time order, after this->horizon)
+        virtual void Refill() = 0;
+
+        void DoDispose() override
+        {
+            this->arrival = ArrivalCallback();
+            Object::DoDispose();
+        }
+
+        uint32_t deviceCount;
+        uint32_t batchSize;
+        Time horizon; // every arrival before this time has been generated
+
+        std::deque<TrafficArrival> block;
+
+    private:
+        // refill until there is an arrival, a refill can cover a window without any;
+        // stops when a refill does not advance the horizon (nothing generated here)
+        void Fill()
+        {
+            while(this->block.empty())
+            {
+                Time horizon = this->horizon;
+                this->Refill();
+                if(this->horizon == horizon)
+                {
+                    return;
+                }
+            }
+        }
+
+        void ScheduleNext()
+        {
+            if(this->block.empty())
+            {
+                return;
+            }
+            this->nextTime = this->block.front().time;
+            this->nextEvent = Simulator::Schedule(
+                this->nextTime - Simulator::Now(),
+                &PanTrafficGenerator::Fire,
+                this
+            );
+        }
+
+        void Fire()
+        {
+            Time now = Simulator::Now();
+            while(!this->block.empty() && this->block.front().time <= now)
+            {
+                uint32_t device = this->block.front().device;
+                this->block.pop_front();
+                this->arrival(device);
+            }
+
+            this->Fill();
+            this->ScheduleNext();
+        }
+
+        ArrivalCallback arrival;
+        bool running;
+        EventId nextEvent;
+        Time nextTime;
+};
+
+/*
+ * N independent Poisson sources of rate lambda are one Poisson source of rate
+ * N * lambda whose arrivals are spread uniformly over the devices.
+ */
+class PoissonTrafficGenerator: public PanTrafficGenerator
+{
+    public:
+        static TypeId GetTypeId(void) {
+            static TypeId tid = TypeId("PoissonTrafficGenerator")
+                .SetParent<PanTrafficGenerator>()
+                .SetGroupName("Network")
+                .AddConstructor<PoissonTrafficGenerator>();
+            return tid;
+        }
+
+        PoissonTrafficGenerator()
+            : rate(1.0)
+        {
+            this->interArrival = CreateObject<ExponentialRandomVariable>();
+            this->device = CreateObject<UniformRandomVariable>();
+        }
+
+        void SetRate(double packetsPerSecond) // per end device
+        {
+            this->rate = packetsPerSecond;
+        }
+
+        int64_t AssignStreams(int64_t stream) override
+        {
+            this->interArrival->SetStream(stream);
+            this->device->SetStream(stream + 1);
+            return 2;
+        }
+
+    protected:
+        void Refill() override
+        {
+            double mean = 1.0 / (this->rate * this->deviceCount);
+            Time t = this->horizon;
+
+            for(uint32_t i = 0; i < this->batchSize; i++)
+            {
+                t += Seconds(this->interArrival->GetValue(mean, 0));
+                this->block.push_back({t, this->device->GetInteger(1, this->deviceCount)});
+            }
+            this->horizon = t;
+        }
+
+    private:
+        double rate;
+        Ptr<ExponentialRandomVariable> interArrival;
+        Ptr<UniformRandomVariable> device;
+};
+
+/*
+ * Each device alternates exponentially distributed ON and OFF periods and
+ * sends at a constant peak rate while ON. Rates are given as the long-term
+ * mean so the offered load matches the other models.
+ */
+class OnOffTrafficGenerator: public PanTrafficGenerator
+{
+    public:
+        static TypeId GetTypeId(void) {
+            static TypeId tid = TypeId("OnOffTrafficGenerator")
+                .SetParent<PanTrafficGenerator>()
+                .SetGroupName("Network")
+                .AddConstructor<OnOffTrafficGenerator>();
+            return tid;
+        }
+
+        OnOffTrafficGenerator()
+            : rate(1.0),
+              onTime(1.0),
+              offTime(9.0)
+        {
+            this->period = CreateObject<ExponentialRandomVariable>();
+        }
+
+        void SetRate(double packetsPerSecond) // mean, per end device
+        {
+            this->rate = packetsPerSecond;
+        }
+
+        void SetOnOffTime(double meanOn, double meanOff) // seconds
+        {
+            this->onTime = meanOn;
+            this->offTime = meanOff;
+        }
+
+        void Start() override
+        {
+            this->devices.assign(this->deviceCount, DeviceState());
+            for(auto& state : this->devices)
+            {
+                // start in OFF with a residual period, so devices are not synchronized
+                state.on = false;
+                state.periodEnd = Simulator::Now() + Seconds(this->period->GetValue(this->offTime, 0));
+            }
+            PanTrafficGenerator::Start();
+        }
+
+        int64_t AssignStreams(int64_t stream) override
+        {
+            this->period->SetStream(stream);
+            return 1;
+        }
+
+    protected:
+        void Refill() override
+        {
+            // one refill covers the time in which about batchSize packets are expected,
+            // a device sends at the peak rate rate * (on + off) / on while ON
+            Time interval = Seconds(this->onTime / (this->rate * (this->onTime + this->offTime)));
+            Time window = Seconds(this->batchSize / (this->rate * this->deviceCount));
+            Time end = this->horizon + window;
+            size_t first = this->block.size();
+
+            for(uint32_t d = 0; d < this->deviceCount; d++)
+            {
+                DeviceState& state = this->devices[d];
+                while(true)
+                {
+                    if(state.on)
+                    {
+                        while(state.nextSend < state.periodEnd && state.nextSend < end)
+                        {
+                            this->block.push_back({state.nextSend, d + 1});
+                            state.nextSend += interval;
+                        }
+                        if(state.nextSend < state.periodEnd)
+                        {
+                            break;
+                        }
+                        state.on = false;
+                        state.periodEnd += Seconds(this->period->GetValue(this->offTime, 0));
+                    }
+                    else
+                    {
+                        if(state.periodEnd >= end)
+                        {
+                            break;
+                        }
+                        state.on = true;
+                        state.nextSend = state.periodEnd;
+                        state.periodEnd += Seconds(this->period->GetValue(this->onTime, 0));
+                    }
+                }
+            }
+
+            std::sort(this->block.begin() + first, this->block.end());
+            this->horizon = end;
+        }
+
+    private:
+        struct DeviceState
+        {
+            bool on;
+            Time periodEnd;
+            Time nextSend;
+        };
+
+        double rate;
+        double onTime;
+        double offTime;
+        Ptr<ExponentialRandomVariable> period;
+        std::vector<DeviceState> devices;
+};
+
+/*
+ * Generator fed exclusively by a SharedEventProcess.
+ */
+class EventTrafficGenerator: public PanTrafficGenerator
+{
+    public:
+        static TypeId GetTypeId(void) {
+            static TypeId tid = TypeId("EventTrafficGenerator")
+                .SetParent<PanTrafficGenerator>()
+                .SetGroupName("Network")
+                .AddConstructor<EventTrafficGenerator>();
+            return tid;
+        }
+
+        void SetPosition(Vector position) // PAN center
+        {
+            this->position = position;
+        }
+
+        Vector GetPosition() const
+        {
+            return this->position;
+        }
+
+        uint32_t GetDeviceCount() const
+        {
+            return this->deviceCount;
+        }
+
+        int64_t AssignStreams(int64_t stream) override
+        {
+            return 0;
+        }
+
+    protected:
+        void Refill() override
+        {
+            // arrivals are pushed by the shared event process
+        }
+
+    private:
+        Vector position;
+};
+
+/*
+ * City-wide Poisson process of physical events (e.g. a door opening, a fire
+ * alarm) at uniformly random positions. Every PAN within `radius` of an event
+ * reports it: each of its devices sends with probability `probability` after a
+ * uniform reaction delay in [0, jitter]. Events are generated a window at a
+ * time and distributed to the affected generators in one merge per PAN.
+ */
+class SharedEventProcess: public Object
+{
+    public:
+        static TypeId GetTypeId(void) {
+            static TypeId tid = TypeId("SharedEventProcess")
+                .SetParent<Object>()
+                .SetGroupName("Network")
+                .AddConstructor<SharedEventProcess>();
+            return tid;
+        }
+
+        SharedEventProcess()
+            : eventRate(1.0),
+              radius(30.0),
+              probability(1.0),
+              jitter(0.05),
+              batchSize(64),
+              min(1e18, 1e18, 0),
+              max(-1e18, -1e18, 0)
+        {
+            this->interArrival = CreateObject<ExponentialRandomVariable>();
+            this->uniform = CreateObject<UniformRandomVariable>();
+        }
+
+        void SetEventRate(double eventsPerSecond)
+        {
+            this->eventRate = eventsPerSecond;
+        }
+
+        void SetRadius(double meters)
+        {
+            this->radius = meters;
+        }
+
+        void SetReportProbability(double p)
+        {
+            this->probability = p;
+        }
+
+        void SetJitter(double seconds)
+        {
+            this->jitter = seconds;
+        }
+
+        void SetBatchSize(uint32_t size)
+        {
+            this->batchSize = std::max<uint32_t>(size, 1);
+        }
+
+        void AddGenerator(Ptr<EventTrafficGenerator> generator) // after SetRadius()
+        {
+            this->generators.push_back(generator);
+
+            // events can happen anywhere a PAN could hear them
+            Vector p = generator->GetPosition();
+            this->min.x = std::min(this->min.x, p.x - this->radius);
+            this->min.y = std::min(this->min.y, p.y - this->radius);
+            this->max.x = std::max(this->max.x, p.x + this->radius);
+            this->max.y = std::max(this->max.y, p.y + this->radius);
+        }
+
+        void Start()
+        {
+            this->horizon = Simulator::Now();
+            this->Refill();
+        }
+
+        // fraction of the event area covered by one PAN, used to match the offered load
+        double GetCoverage() const
+        {
+            double area = (this->max.x - this->min.x) * (this->max.y - this->min.y);
+            return area > 0 ? std::min(1.0, M_PI * this->radius * this->radius / area) : 1.0;
+        }
+
+        int64_t AssignStreams(int64_t stream)
+        {
+            this->interArrival->SetStream(stream);
+            this->uniform->SetStream(stream + 1);
+            return 2;
+        }
+
+    private:
+        void Refill()
+        {
+            std::vector<std::vector<TrafficArrival>> arrivals(this->generators.size());
+            Time t = this->horizon;
+
+            for(uint32_t i = 0; i < this->batchSize; i++)
+            {
+                t += Seconds(this->interArrival->GetValue(1.0 / this->eventRate, 0));
+                double x = this->uniform->GetValue(this->min.x, this->max.x);
+                double y = this->uniform->GetValue(this->min.y, this->max.y);
+
+                for(size_t g = 0; g < this->generators.size(); g++)
+                {
+                    Vector p = this->generators[g]->GetPosition();
+                    double dx = p.x - x;
+                    double dy = p.y - y;
+                    if(dx * dx + dy * dy > this->radius * this->radius)
+                    {
+                        continue;
+                    }
+                    for(uint32_t d = 1; d <= this->generators[g]->GetDeviceCount(); d++)
+                    {
+                        if(this->uniform->GetValue() < this->probability)
+                        {
+                            arrivals[g].push_back({t + Seconds(this->uniform->GetValue(0, this->jitter)), d});
+                        }
+                    }
+                }
+            }
+
+            for(size_t g = 0; g < this->generators.size(); g++)
+            {
+                if(!arrivals[g].empty())
+                {
+                    this->generators[g]->AddArrivals(arrivals[g]);
+                }
+            }
+
+            this->horizon = t;
+            Simulator::Schedule(t - Simulator::Now(), &SharedEventProcess::Refill, this);
+        }
+
+        void DoDispose() override
+        {
+            this->generators.clear();
+            Object::DoDispose();
+        }
+
+        double eventRate;
+        double radius;
+        double probability;
+        double jitter;
+        uint32_t batchSize;
+        Time horizon;
+        Vector min;
+        Vector max;
+
+        Ptr<ExponentialRandomVariable> interArrival;
+        Ptr<UniformRandomVariable> uniform;
+        std::vector<Ptr<EventTrafficGenerator>> generators;
+};
+
+} // namespace ns3
+
+#endif /* DU_WPAN_TRAFFIC_H */
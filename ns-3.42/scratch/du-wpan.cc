@@ -36,8 +36,24 @@
 #include <ns3/propagation-module.h>
 #include <ns3/spectrum-module.h>
 
+#include <chrono>
+#include <numeric>
 #include <vector>
 #include <iostream>
+#include <sstream>
+
+#include "du-wpan-abstract.h"
+#include "du-wpan-aggregate.h"
+#include "du-wpan-channel.h"
+#include "du-wpan-distributed.h"
+#include "du-wpan-energy.h"
+#include "du-wpan-mobility.h"
+#include "du-wpan-propagation.h"
+#include "du-wpan-queue.h"
+#include "du-wpan-results.h"
+#include "du-wpan-superframe.h"
+#include "du-wpan-telemetry.h"
+#include "du-wpan-traffic.h"
 
 // using namespace std;
 using namespace ns3;
@@ -53,25 +69,560 @@ using namespace ns3::lrwpan;
 #define SIM_TIME 3600
 #define SLOT_LENGTH 1   // ms
 #define SPREAD_RANGE 5 // default 20
+#define PAN_SPACING 20  // distance between PAN centers along each axis
+
+#define PHY_OVERHEAD 6      // preamble, SFD and PHR (bytes)
+#define PHY_BYTE_DURATION 32 // us per byte, O-QPSK 2.4 GHz (250 kbps)
+#define SLEEP_GUARD 1       // ms the receiver stays on after the slot ends
+
+#define TRAFFIC_STREAM 1000 // first RNG stream of the traffic models
+
+// runtime configuration, defaults follow the macros above
+struct ScenarioConfig
+{
+    uint32_t panCount = PAN_COUNT;
+    uint32_t nodeCount = NODE_COUNT; // coordinator included
+    std::string layout = "line";     // line: PANs along the diagonal, grid: square grid
+    std::string phyMode = "spectrum"; // spectrum: LrWpanNetDevice, abstract: AbstractLrWpanMedium
+    double abstractCutoff = -119.2;  // abstract: weakest link kept in the link budget table (dBm)
+    bool exactErrorModel = false;    // abstract: error formula instead of the lookup table
+    bool urban = false;              // buildings on a street grid, UrbanBuildingPropagationLossModel
+    double blockSize = 40;           // urban: building footprint side (m)
+    double streetWidth = 15;         // urban: street between buildings (m)
+    uint32_t floors = 6;             // urban: floors per building, PANs are spread over them
+    double floorHeight = 3;          // urban: m
+    uint32_t rooms = 4;              // urban: rooms along each side of a floor
+    double maxLoss = 119.2;          // urban: links with more loss are out of reach (dB)
+    std::string linkCache = "";      // urban: directory of link table files, empty: no cache
+    std::string resultCache = "";    // directory of finished runs, a run found there is replayed, empty: no cache
+    std::string traffic = "slotted"; // slotted | poisson | onoff | event
+    double rate = 0;                 // packets/s per end device, 0: same offered load as slotted
+    uint32_t batchSize = 64;         // arrivals generated per refill
+    double onTime = 1;               // onoff: mean ON period (s)
+    double offTime = 9;              // onoff: mean OFF period (s)
+    double eventRadius = 30;         // event: PANs within this distance report an event (m)
+    double eventProbability = 0.8;   // event: probability that a device reports an event
+    double eventJitter = 0.05;       // event: maximum reaction delay (s)
+    uint32_t queueCapacity = 16;     // packets per end device, 0: unbounded
+    std::string dropPolicy = "tail"; // tail: drop arriving packet, head: drop oldest packet
+    bool ack = false;                // request MAC acknowledgments (TX_OPTION_ACK)
+    uint32_t maxFrameRetries = 3;    // macMaxFrameRetries
+    uint32_t minBE = 3;              // macMinBE
+    uint32_t maxBE = 5;              // macMaxBE
+    uint32_t maxCsmaBackoffs = 4;    // macMaxCSMABackoffs
+    double batteryEnergy = 27000;    // initial energy of every device (J)
+    bool sleepy = false;             // end device receivers off outside their slot
+    uint32_t channelWorkers = 0;     // extra threads for the receiver fan-out, 0: SingleModelSpectrumChannel
+    uint32_t parallelThreshold = 64; // minimum receivers of a transmission for the parallel fan-out
+    std::string mac = "tdma";        // tdma: slots emulated over the non-beacon MAC, gts: beacon-enabled superframes with GTS
+    uint32_t superframeOrder = 3;    // gts: SO
+    int beaconOrder = -1;            // gts: BO, -1: smallest that separates every PAN in time
+    std::string mobility = "static"; // static | pedestrian | vehicle, end devices only
+    double mobileFraction = 0.2;     // share of end devices that move
+    double positionInterval = 1;     // time between two position updates of a moving device (s)
+    double progress = 30;            // wall clock seconds between progress reports, 0: none
+    std::string progressFile = "";   // progress report file, rewritten every report, empty: stdout
+    uint32_t aggregate = 1;          // readings per data frame at most, 1: one reading per frame
+    double aggregationDelay = 0.05;  // longest wait of a reading for more to share its frame (s)
+};
+
+ScenarioConfig config;
+
+// everything a run depends on besides the binary, key of the result cache;
+// channelWorkers and parallelThreshold are left out, the parallel fan-out gives the same results
+std::string RunDescription(int argc, char* argv[])
+{
+    std::ostringstream description;
+    description.precision(17);
+    description << "seed=" << RngSeedManager::GetSeed()
+                << " run=" << RngSeedManager::GetRun()
+                << " panCount=" << config.panCount
+                << " nodeCount=" << config.nodeCount
+                << " layout=" << config.layout
+                << " phyMode=" << config.phyMode
+                << " abstractCutoff=" << config.abstractCutoff
+                << " exactErrorModel=" << config.exactErrorModel
+                << " urban=" << config.urban
+                << " blockSize=" << config.blockSize
+                << " streetWidth=" << config.streetWidth
+                << " floors=" << config.floors
+                << " floorHeight=" << config.floorHeight
+                << " rooms=" << config.rooms
+                << " maxLoss=" << config.maxLoss
+                << " traffic=" << config.traffic
+                << " rate=" << config.rate
+                << " batchSize=" << config.batchSize
+                << " onTime=" << config.onTime
+                << " offTime=" << config.offTime
+                << " eventRadius=" << config.eventRadius
+                << " eventProbability=" << config.eventProbability
+                << " eventJitter=" << config.eventJitter
+                << " queueCapacity=" << config.queueCapacity
+                << " dropPolicy=" << config.dropPolicy
+                << " ack=" << config.ack
+                << " maxFrameRetries=" << config.maxFrameRetries
+                << " minBE=" << config.minBE
+                << " maxBE=" << config.maxBE
+                << " maxCsmaBackoffs=" << config.maxCsmaBackoffs
+                << " batteryEnergy=" << config.batteryEnergy
+                << " sleepy=" << config.sleepy
+                << " mac=" << config.mac
+                << " superframeOrder=" << config.superframeOrder
+                << " beaconOrder=" << config.beaconOrder
+                << " mobility=" << config.mobility
+                << " mobileFraction=" << config.mobileFraction
+                << " positionInterval=" << config.positionInterval
+                << " aggregate=" << config.aggregate
+                << " aggregationDelay=" << config.aggregationDelay
+                << " PACKET_SIZE=" << PACKET_SIZE
+                << " SLOT_LENGTH=" << SLOT_LENGTH
+                << " SLOT_INTERVAL=" << SLOT_INTERVAL
+                << " SPREAD_RANGE=" << SPREAD_RANGE
+                << " PAN_SPACING=" << PAN_SPACING
+                << " SLEEP_GUARD=" << SLEEP_GUARD;
+    #ifdef NOISY_SLOT_INTERVAL
+    description << " NOISY_SLOT_INTERVAL=" << NOISY_SLOT_INTERVAL;
+    #endif
+
+    // attribute defaults set on the command line
+    std::vector<std::string> attributes;
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::string(argv[i]).rfind("--ns3::", 0) == 0)
+        {
+            attributes.push_back(argv[i] + 2);
+        }
+    }
+    std::sort(attributes.begin(), attributes.end());
+    for(const std::string& attribute : attributes)
+    {
+        description << " " << attribute;
+    }
+    return description.str();
+}
+
+// per-device packet rate of the slotted loop in SendData()
+double SlottedRate()
+{
+    return 1000.0 / ((SLOT_LENGTH * (config.nodeCount - 1) + SLOT_INTERVAL) * config.panCount);
+}
 
 int totalRequestedTX = 0;
 int totalTriedTX = 0;
 int totalSuccessfulRX = 0;
+int deliveredMessages = 0; // readings received by coordinators, totalSuccessfulRX counts frames
+
+Ptr<QueueStats> queueStats = Create<QueueStats>();
+
+// MCPS-DATA.confirm by status
+int confirmSuccess = 0;
+int confirmNoAck = 0;
+int confirmChannelAccessFailure = 0;
+int confirmOther = 0;
+
+// what actually went on air
+uint64_t totalDeliveredBytes = 0; // MSDU bytes received by coordinators
+int endDeviceRxFrames = 0;        // frames demodulated by end devices, none of them is theirs
+int dataFramesOnAir = 0;          // end device transmissions, retries included
+int retransmissions = 0;
+Time dataAirtime;
+Time retryAirtime;
+Time coordinatorAirtime;          // ACKs (and beacons) sent by coordinators
+
+Time FrameAirtime(uint32_t psduSize)
+{
+    return MicroSeconds((PHY_OVERHEAD + psduSize) * PHY_BYTE_DURATION);
+}
+
+void printEnergyStats(); // needs PANNetwork
+
+// shared by every PAN in abstract PHY mode
+Ptr<AbstractLrWpanMedium> medium;
+
+// output of this run, stored under its key when it finishes
+Ptr<ResultStore> resultStore;
+
+// superframe layout of every PAN in GTS mode
+Ptr<GtsSchedule> gtsSchedule;
+int beaconLosses = 0;
+
+// urban: shared by every channel, keeps the link table of moving devices current
+Ptr<UrbanBuildingPropagationLossModel> urbanModel;
+
+// moving end devices, their position is updated every config.positionInterval
+Ptr<MobilitySampler> mobilitySampler;
+
+// processes of a partitioned run, a single region without MPI
+Ptr<RegionExchange> regions;
+std::vector<uint32_t> panRegions; // region of every PAN
+
+// readings per data frame, limited by aMaxPHYPacketSize
+uint32_t AggregateLimit()
+{
+    uint32_t capacity = AggregateHeader::GetCapacity(aMaxPhyPacketSize - LRWPAN_DATA_OVERHEAD, PACKET_SIZE);
+    return std::max<uint32_t>(std::min(config.aggregate, capacity), 1);
+}
+
+// MSDU of a full data frame
+uint32_t MaxMsduSize()
+{
+    if(config.aggregate > 1)
+    {
+        return AggregateHeader::GetMsduSize(AggregateLimit(), PACKET_SIZE);
+    }
+    return PACKET_SIZE;
+}
+
+// one transaction of the slotted CSMA-CA in a free channel: backoff boundary, 2 CCA, frame, ACK, IFS
+Time GtsTransaction()
+{
+    Time transaction = MicroSeconds(3 * LRWPAN_UNIT_BACKOFF + LRWPAN_TURNAROUND + LRWPAN_LIFS)
+                       + FrameAirtime(LRWPAN_DATA_OVERHEAD + MaxMsduSize());
+    if(config.ack)
+    {
+        transaction += MicroSeconds(LRWPAN_TURNAROUND + LRWPAN_UNIT_BACKOFF) + FrameAirtime(LRWPAN_ACK_SIZE);
+    }
+    return transaction;
+}
+
+std::string MacDescription()
+{
+    if(!gtsSchedule)
+    {
+        return "tdma (emulated slots, non-beacon CSMA-CA)";
+    }
+
+    std::ostringstream description;
+    description << "gts (BO " << gtsSchedule->GetBeaconOrder()
+                << ", SO " << gtsSchedule->GetSuperframeOrder()
+                << ", beacon offsets " << gtsSchedule->GetOffsetCount()
+                << ", " << gtsSchedule->GetDescriptorCount() << " GTS of " << gtsSchedule->GetSlotsPerGts() << " slot(s)"
+                << ", superframes per round " << gtsSchedule->GetRoundLength()
+                << ", beacon losses " << beaconLosses << ")";
+    return description.str();
+}
+
+std::string MobilityDescription()
+{
+    if(!mobilitySampler)
+    {
+        return "static";
+    }
+
+    std::ostringstream description;
+    description << config.mobility
+                << " (moving devices " << mobilitySampler->GetDeviceCount()
+                << ", position updates " << mobilitySampler->GetMoveCount();
+    if(medium)
+    {
+        description << ", medium link updates " << medium->GetLinkUpdateCount();
+    }
+    if(urbanModel)
+    {
+        description << ", moved nodes in the link table " << urbanModel->GetMovedNodeCount();
+    }
+    description << ")";
+    return description.str();
+}
+
+Vector PanCenter(uint32_t panId)
+{
+    if(config.layout == "grid")
+    {
+        uint32_t columns = (uint32_t) std::ceil(std::sqrt((double) config.panCount));
+        return Vector((panId % columns) * PAN_SPACING, (panId / columns) * PAN_SPACING, 0);
+    }
+    NS_ABORT_MSG_IF(config.layout != "line", "unknown layout: " << config.layout);
+    return Vector(panId * PAN_SPACING, panId * PAN_SPACING, 0);
+}
+
+// urban: PANs take the floors in turn, devices 1 m above the floor
+double PanHeight(uint32_t panId)
+{
+    return config.urban ? (panId % config.floors) * config.floorHeight + 1 : 0;
+}
+
+// urban: street grid of buildings over every PAN, the first PAN in the middle of a building
+void AddCityBlocks(Ptr<UrbanBuildingPropagationLossModel> model)
+{
+    double period = config.blockSize + config.streetWidth;
+    double xMax = 0;
+    double yMax = 0;
+    for(uint32_t i = 0; i < config.panCount; i++)
+    {
+        xMax = std::max(xMax, PanCenter(i).x);
+        yMax = std::max(yMax, PanCenter(i).y);
+    }
+
+    for(double x = -config.blockSize / 2; x <= xMax + SPREAD_RANGE; x += period)
+    {
+        for(double y = -config.blockSize / 2; y <= yMax + SPREAD_RANGE; y += period)
+        {
+            UrbanBuildingPropagationLossModel::Building building;
+            building.xMin = x;
+            building.xMax = x + config.blockSize;
+            building.yMin = y;
+            building.yMax = y + config.blockSize;
+            building.floors = config.floors;
+            building.floorHeight = config.floorHeight;
+            building.roomsX = config.rooms;
+            building.roomsY = config.rooms;
+            model->AddBuilding(building);
+        }
+    }
+}
+
+// partitioned run: PANs sorted by x (then y) in strips of equal PAN count, one per region
+void AssignRegions(uint32_t regionCount)
+{
+    std::vector<uint32_t> order(config.panCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [](uint32_t a, uint32_t b) {
+        Vector p = PanCenter(a);
+        Vector q = PanCenter(b);
+        return p.x < q.x || (p.x == q.x && p.y < q.y);
+    });
+
+    panRegions.assign(config.panCount, 0);
+    for(uint32_t i = 0; i < config.panCount; i++)
+    {
+        panRegions[order[i]] = (uint64_t) i * regionCount / config.panCount;
+    }
+}
+
+// simulated by this process
+bool IsLocalPan(uint32_t panId)
+{
+    return panRegions.empty() || panRegions[panId] == regions->GetRegion();
+}
+
+// every PAN with its devices, where moving devices stay
+Rectangle DeploymentArea()
+{
+    Vector center = PanCenter(0);
+    Rectangle area(center.x, center.x, center.y, center.y);
+    for(uint32_t i = 1; i < config.panCount; i++)
+    {
+        center = PanCenter(i);
+        area.xMin = std::min(area.xMin, center.x);
+        area.xMax = std::max(area.xMax, center.x);
+        area.yMin = std::min(area.yMin, center.y);
+        area.yMax = std::max(area.yMax, center.y);
+    }
+    area.xMin -= SPREAD_RANGE;
+    area.xMax += SPREAD_RANGE;
+    area.yMin -= SPREAD_RANGE;
+    area.yMax += SPREAD_RANGE;
+    return area;
+}
+
+// partitioned run: every region counts its own PANs, printResult() shows the totals
+struct RegionCounters
+{
+    std::vector<double> sums;
+    std::vector<double> maxima;
+};
+
+RegionCounters GetCounters()
+{
+    RegionCounters counters;
+    counters.sums = {
+        (double) totalRequestedTX,
+        (double) totalTriedTX,
+        (double) totalSuccessfulRX,
+        (double) deliveredMessages,
+        (double) confirmSuccess,
+        (double) confirmNoAck,
+        (double) confirmChannelAccessFailure,
+        (double) confirmOther,
+        (double) totalDeliveredBytes,
+        (double) endDeviceRxFrames,
+        (double) dataFramesOnAir,
+        (double) retransmissions,
+        (double) dataAirtime.GetNanoSeconds(),
+        (double) retryAirtime.GetNanoSeconds(),
+        (double) coordinatorAirtime.GetNanoSeconds(),
+        (double) queueStats->enqueued,
+        (double) queueStats->dropped,
+        (double) queueStats->served,
+        (double) queueStats->completed,
+        (double) queueStats->backlog,
+        (double) queueStats->sojournSum.GetNanoSeconds(),
+        (double) queueStats->serviceSum.GetNanoSeconds(),
+        (double) queueStats->delivered,
+        (double) queueStats->latencySum.GetNanoSeconds(),
+        queueStats->latencySquares,
+        queueStats->GetBacklogIntegral(),
+    };
+    counters.maxima = {
+        (double) queueStats->maxLength,
+        (double) queueStats->sojournMax.GetNanoSeconds(),
+        (double) queueStats->serviceMax.GetNanoSeconds(),
+        (double) queueStats->latencyMax.GetNanoSeconds(),
+    };
+    return counters;
+}
+
+void SetCounters(const RegionCounters& counters)
+{
+    const double* sum = counters.sums.data();
+    totalRequestedTX = (int) *sum++;
+    totalTriedTX = (int) *sum++;
+    totalSuccessfulRX = (int) *sum++;
+    deliveredMessages = (int) *sum++;
+    confirmSuccess = (int) *sum++;
+    confirmNoAck = (int) *sum++;
+    confirmChannelAccessFailure = (int) *sum++;
+    confirmOther = (int) *sum++;
+    totalDeliveredBytes = (uint64_t) *sum++;
+    endDeviceRxFrames = (int) *sum++;
+    dataFramesOnAir = (int) *sum++;
+    retransmissions = (int) *sum++;
+    dataAirtime = NanoSeconds((int64_t) *sum++);
+    retryAirtime = NanoSeconds((int64_t) *sum++);
+    coordinatorAirtime = NanoSeconds((int64_t) *sum++);
+    queueStats->enqueued = (uint64_t) *sum++;
+    queueStats->dropped = (uint64_t) *sum++;
+    queueStats->served = (uint64_t) *sum++;
+    queueStats->completed = (uint64_t) *sum++;
+    queueStats->backlog = (uint64_t) *sum++;
+    queueStats->sojournSum = NanoSeconds((int64_t) *sum++);
+    queueStats->serviceSum = NanoSeconds((int64_t) *sum++);
+    queueStats->delivered = (uint64_t) *sum++;
+    queueStats->latencySum = NanoSeconds((int64_t) *sum++);
+    queueStats->latencySquares = *sum++;
+    queueStats->SetBacklogIntegral(*sum++);
+
+    const double* max = counters.maxima.data();
+    queueStats->maxLength = (uint32_t) *max++;
+    queueStats->sojournMax = NanoSeconds((int64_t) *max++);
+    queueStats->serviceMax = NanoSeconds((int64_t) *max++);
+    queueStats->latencyMax = NanoSeconds((int64_t) *max++);
+}
+
+void printQueueStats()
+{
+    uint64_t served = std::max<uint64_t>(queueStats->served, 1);
+    uint64_t completed = std::max<uint64_t>(queueStats->completed, 1);
+
+    NS_LOG_UNCOND(
+        "QUEUE (capacity: "
+        << config.queueCapacity
+        << ", drop: "
+        << config.dropPolicy
+        << ")\nenqueued: "
+        << queueStats->enqueued
+        << "\tdropped: "
+        << queueStats->dropped
+        << "\tbacklog: "
+        << queueStats->backlog
+        << "\tmean queue length: "
+        << queueStats->GetMeanBacklog() / (config.panCount * (config.nodeCount - 1))
+        << "\tmax queue length: "
+        << queueStats->maxLength
+        << "\nmean sojourn(ms): "
+        << queueStats->sojournSum.GetSeconds() * 1000 / served
+        << "\tmax sojourn(ms): "
+        << queueStats->sojournMax.GetSeconds() * 1000
+        << "\tmean MAC service(ms): "
+        << queueStats->serviceSum.GetSeconds() * 1000 / completed
+        << "\tmax MAC service(ms): "
+        << queueStats->serviceMax.GetSeconds() * 1000
+        << "\nmean latency(ms): "
+        << queueStats->GetMeanLatency() * 1000
+        << "\tlatency deviation(ms): "
+        << queueStats->GetLatencyDeviation() * 1000
+        << "\tmax latency(ms): "
+        << queueStats->latencyMax.GetSeconds() * 1000
+        << "\n\n"
+    );
+}
+
+void printReliabilityStats()
+{
+    double elapsed = std::max(Simulator::Now().GetSeconds(), 1e-9);
+
+    NS_LOG_UNCOND(
+        "RELIABILITY (ACK: "
+        << (config.ack ? "on" : "off")
+        << ", macMaxFrameRetries: "
+        << config.maxFrameRetries
+        << ", macMinBE: "
+        << config.minBE
+        << ", macMaxBE: "
+        << config.maxBE
+        << ", macMaxCSMABackoffs: "
+        << config.maxCsmaBackoffs
+        << ")\nconfirm SUCCESS: "
+        << confirmSuccess
+        << "\tNO_ACK: "
+        << confirmNoAck
+        << "\tCHANNEL_ACCESS_FAILURE: "
+        << confirmChannelAccessFailure
+        << "\tother: "
+        << confirmOther
+        << "\ndata frames on air: "
+        << dataFramesOnAir
+        << "\tretransmissions: "
+        << retransmissions
+        << "\tdata airtime(s): "
+        << dataAirtime.GetSeconds()
+        << "\tretry airtime(s): "
+        << retryAirtime.GetSeconds()
+        << " ("
+        << retryAirtime.GetSeconds() * 100 / std::max(dataAirtime.GetSeconds(), 1e-9)
+        << "%)\tcoordinator airtime(s): "
+        << coordinatorAirtime.GetSeconds()
+        << "\ngoodput(kbps): "
+        << totalDeliveredBytes * 8 / elapsed / 1000
+        << "\tdelivered per frame on air: "
+        << (double) totalSuccessfulRX / std::max(dataFramesOnAir, 1)
+        << "\nAGGREGATION (readings per frame: "
+        << AggregateLimit()
+        << ", delay(ms): "
+        << (config.aggregate > 1 ? config.aggregationDelay * 1000 : 0)
+        << ")\ndelivered messages: "
+        << deliveredMessages
+        << "\tmessages per frame: "
+        << (double) deliveredMessages / std::max(totalSuccessfulRX, 1)
+        << "\tmessages/s: "
+        << deliveredMessages / elapsed
+        << "\n\n"
+    );
+}
 
 void printResult()
 {
+    // totals of every region while printing, own counters again afterwards
+    RegionCounters local;
+    if(regions->GetRegionCount() > 1)
+    {
+        local = GetCounters();
+        RegionCounters total = local;
+        regions->Sum(total.sums);
+        regions->Max(total.maxima);
+        SetCounters(total);
+    }
+
     #ifdef NOISY_SLOT_INTERVAL
     NS_LOG_UNCOND(
         "\n\nCONFIGURATION\nPAN network count: "
-        << PAN_COUNT
+        << config.panCount
         << "\nnode count per PAN: "
-        << NODE_COUNT
+        << config.nodeCount
+        << "\nMAC: "
+        << MacDescription()
+        << "\nmobility: "
+        << MobilityDescription()
         << "\nslot interval(ms): "
         << SLOT_INTERVAL
         << "\nNONE"
         << NOISY_SLOT_INTERVAL
         << "\npacket size: "
         << PACKET_SIZE
+        << "\ntraffic model: "
+        << config.traffic
+        << " (" << config.rate << " pkt/s per device)"
         << "\ntotal Requested TX: "
         << totalRequestedTX
         << "\ntotal Tried TX: "
@@ -85,9 +636,13 @@ void printResult()
     #else
         NS_LOG_UNCOND(
         "\n\nCONFIGURATION\nPAN network count: "
-        << PAN_COUNT
+        << config.panCount
         << "\nnode count per PAN: "
-        << NODE_COUNT
+        << config.nodeCount
+        << "\nMAC: "
+        << MacDescription()
+        << "\nmobility: "
+        << MobilityDescription()
         << "\nslot length(ms): "
         << SLOT_LENGTH
         << "\nslot interval(ms): "
@@ -95,6 +650,9 @@ void printResult()
         << "\nBEACON_SHIFTING"
         << "\npacket size: "
         << PACKET_SIZE
+        << "\ntraffic model: "
+        << config.traffic
+        << " (" << config.rate << " pkt/s per device)"
         << "\ntotal Requested TX: "
         << totalRequestedTX
         << "\ntotal Tried TX: "
@@ -106,15 +664,34 @@ void printResult()
         << "%\n\n"
     );
     #endif
+
+    printQueueStats();
+    printReliabilityStats();
+    printEnergyStats();
+
+    if(regions->GetRegionCount() > 1)
+    {
+        SetCounters(local);
+    }
+
+    if(resultStore)
+    {
+        resultStore->Checkpoint();
+    }
 }
 
-void aaa()
+// progress reports of this run
+Ptr<ProgressMonitor> progressMonitor;
+
+// fields of the progress report
+double DeliveryRatio()
 {
-    NS_LOG_UNCOND(Simulator::Now().As(Time::S) << "\t !!");
-    Simulator::Schedule(
-        Seconds(30),
-        MakeEvent(&aaa)
-    );
+    return (double) deliveredMessages / std::max(totalRequestedTX, 1);
+}
+
+double QueueBacklog()
+{
+    return queueStats->backlog;
 }
 
 class PANNetwork: public Object
@@ -140,9 +717,11 @@ class PANNetwork: public Object
             this->mobility.SetPositionAllocator(
                 "ns3::RandomDiscPositionAllocator",
                 "X",
-                DoubleValue(totalPanId * 20), // x축 시작 좌표
+                DoubleValue(PanCenter(totalPanId).x), // x축 시작 좌표
                 "Y",
-                DoubleValue(totalPanId * 20), // y축 시작 좌표
+                DoubleValue(PanCenter(totalPanId).y), // y축 시작 좌표
+                "Z",
+                DoubleValue(PanHeight(totalPanId)),
                 "Rho",
                 PointerValue(random)          // 반경
             );
@@ -159,9 +738,9 @@ class PANNetwork: public Object
             this->channel = channel;
 
             // install mobiilty
-            nodes.Create(NODE_COUNT);
+            nodes.Create(config.nodeCount);
 
-            for(int i = 0; i < NODE_COUNT; i++)
+            for(uint32_t i = 0; i < config.nodeCount; i++)
             {
                 Ptr<Node> node = this->nodes.Get(i);
             }
@@ -169,23 +748,107 @@ class PANNetwork: public Object
         }
 
         // callback methods
-        static void McpsDataConfirmCallback(McpsDataConfirmParams params)
+        static void McpsDataConfirmCallback(PANNetwork* network, uint32_t index, McpsDataConfirmParams params)
         {
             totalTriedTX++;
             // NS_LOG_UNCOND(Simulator::Now().As(Time::S) << "\t" << params.m_status << ": MCPS-DATA confirmed, data successfully sent.");
+
+            switch(params.m_status)
+            {
+                case MacStatus::SUCCESS:
+                    confirmSuccess++;
+                    break;
+                case MacStatus::NO_ACK:
+                    confirmNoAck++;
+                    break;
+                case MacStatus::CHANNEL_ACCESS_FAILURE:
+                    confirmChannelAccessFailure++;
+                    break;
+                default:
+                    confirmOther++;
+                    break;
+            }
+
+            if(network->queues[index])
+            {
+                network->queues[index]->Complete(params.m_status == MacStatus::SUCCESS);
+                network->Transmit(index);
+            }
         }
 
-        static void McpsDataIndicationCallback(McpsDataIndicationParams params, Ptr<Packet> packet)
+        // battery of device `index` empty: no more readings, receiver off once the MAC is idle
+        static void EnergyDepletedCallback(PANNetwork* network, uint32_t index)
+        {
+            if(index < network->flushEvents.size())
+            {
+                network->flushEvents[index].Cancel();
+            }
+            if(medium)
+            {
+                medium->SetRxOnWhenIdle(network->mediumIndex[index], false);
+                return;
+            }
+            DynamicCast<LrWpanNetDevice>(network->GetDevices().Get(index))->GetMac()->SetRxOnWhenIdle(false);
+        }
+
+        static void McpsDataIndicationCallback(PANNetwork* network, McpsDataIndicationParams params, Ptr<Packet> packet)
         {
             totalSuccessfulRX++;
+            if(config.aggregate > 1)
+            {
+                for(Ptr<Packet> reading : AggregateHeader::Unpack(packet))
+                {
+                    deliveredMessages++;
+                    totalDeliveredBytes += reading->GetSize();
+                    network->deliveredBytes += reading->GetSize();
+                }
+                return;
+            }
+            deliveredMessages++;
+            totalDeliveredBytes += packet->GetSize();
+            network->deliveredBytes += packet->GetSize();
             // NS_LOG_UNCOND(Simulator::Now().As(Time::S) << "\tdata from " << params.m_srcExtAddr << " successfully received, MCPS-DATA.indication issued.");
         }
 
+        // every frame an end device puts on air, so retries show up as extra airtime
+        static void PhyTxBeginCallback(PANNetwork* network, uint32_t index, Ptr<const Packet> packet)
+        {
+            Time airtime = FrameAirtime(packet->GetSize());
+
+            if(index == 0)
+            {
+                coordinatorAirtime += airtime;
+                if(gtsSchedule && packet->GetSize() > LRWPAN_ACK_SIZE)
+                {
+                    network->StartSuperframe(); // beacon
+                }
+                return;
+            }
+
+            dataFramesOnAir++;
+            dataAirtime += airtime;
+            if(++network->attempts[index] > 1)
+            {
+                retransmissions++;
+                retryAirtime += airtime;
+            }
+        }
+
+        static void PhyRxBeginCallback(Ptr<const Packet> packet)
+        {
+            endDeviceRxFrames++;
+        }
+
         static void BeaconIndicationCallback(MlmeBeaconNotifyIndicationParams params)
         {
             // NS_LOG_UNCOND(Simulator::Now().GetSeconds() << " secs | Received BEACON packet of size ");
         }
 
+        static void SyncLossCallback(MlmeSyncLossIndicationParams params)
+        {
+            beaconLosses++;
+        }
+
         // getter, setter
         NodeContainer GetNodes()
         {
@@ -207,7 +870,27 @@ class PANNetwork: public Object
             return this->networkId;
         }
 
-        void SetChannel(Ptr<SingleModelSpectrumChannel> channel)
+        Vector GetCenter()
+        {
+            return PanCenter(this->networkId);
+        }
+
+        bool IsLocal() // simulated by this process
+        {
+            return IsLocalPan(this->networkId);
+        }
+
+        std::vector<Ptr<LrWpanRadioEnergyModel>> GetEnergyModels() // must used after Install()
+        {
+            return this->energyModels;
+        }
+
+        uint64_t GetDeliveredBytes()
+        {
+            return this->deliveredBytes;
+        }
+
+        void SetChannel(Ptr<SpectrumChannel> channel)
         {
             this->channel = channel;
             this->helper.SetChannel(channel);
@@ -217,27 +900,195 @@ class PANNetwork: public Object
         void Install()
         {
             this->mobility.Install(this->nodes);
+            if(mobilitySampler)
+            {
+                this->InstallMobility();
+            }
+            if(medium)
+            {
+                this->InstallAbstract();
+                return;
+            }
+
             this->devices = this->helper.Install(this->nodes);
             this->helper.CreateAssociatedPan(this->devices, this->networkId);
+
+            for(uint32_t i = 0; i < this->nodes.GetN(); i++)
+            {
+                Ptr<LrWpanNetDevice> dev = DynamicCast<LrWpanNetDevice>(this->devices.Get(i));
+                dev->GetMac()->SetMacMaxFrameRetries(config.maxFrameRetries);
+                // gts: alone in the channel during its GTS, no random backoff
+                dev->GetCsmaCa()->SetMacMinBE(gtsSchedule ? 0 : config.minBE);
+                dev->GetCsmaCa()->SetMacMaxBE(config.maxBE);
+                dev->GetCsmaCa()->SetMacMaxCSMABackoffs(config.maxCsmaBackoffs);
+
+                // the MAC still turns the receiver on for CCA and ACK wait by itself
+                if(config.sleepy && i > 0)
+                {
+                    dev->GetMac()->SetRxOnWhenIdle(false);
+                }
+            }
+
+            // battery and radio energy model on every device, coordinator included
+            EnergySourceContainer sources = BatteryHelper().Install(this->nodes);
+            LrWpanRadioEnergyModelHelper radioEnergy;
+            DeviceEnergyModelContainer models = radioEnergy.Install(this->devices, sources);
+            for(uint32_t i = 0; i < models.GetN(); i++)
+            {
+                this->AddEnergyModel(i, DynamicCast<LrWpanRadioEnergyModel>(models.Get(i)));
+            }
+
+            this->InstallQueues();
+        }
+
+        // end devices picked with probability config.mobileFraction get a trajectory
+        void InstallMobility()
+        {
+            Ptr<UniformRandomVariable> pick = CreateObject<UniformRandomVariable>();
+            Rectangle area = DeploymentArea();
+            for(uint32_t i = 1; i < this->nodes.GetN(); i++)
+            {
+                if(pick->GetValue() >= config.mobileFraction)
+                {
+                    continue;
+                }
+                Ptr<MobilityModel> position = this->nodes.Get(i)->GetObject<MobilityModel>();
+                mobilitySampler->AddDevice(
+                    MobilitySampler::CreateTrajectory(config.mobility, position->GetPosition(), area),
+                    position,
+                    MakeBoundCallback(&PANNetwork::DeviceMovedCallback, this, i)
+                );
+            }
+        }
+
+        // position already set, only the caches that index it are left
+        static void DeviceMovedCallback(PANNetwork* network, uint32_t index, Vector position)
+        {
+            if(urbanModel)
+            {
+                urbanModel->MoveNode(network->nodes.Get(index)->GetId(), position);
+            }
+            if(medium)
+            {
+                medium->MoveDevice(network->mediumIndex[index], position);
+            }
+        }
+
+        // devices of the shared medium instead of LrWpanNetDevice
+        void InstallAbstract()
+        {
+            for(uint32_t i = 0; i < this->nodes.GetN(); i++)
+            {
+                Vector position = this->nodes.Get(i)->GetObject<MobilityModel>()->GetPosition();
+                uint32_t index = medium->AddDevice(position, !(config.sleepy && i > 0));
+                this->mediumIndex.push_back(index);
+                medium->SetRegion(index, panRegions[this->networkId]);
+                if(!this->IsLocal())
+                {
+                    continue; // an interferer here, simulated by its own region
+                }
+
+                // no PHY to trace, the medium reports the radio state
+                Ptr<EnergySource> source = BatteryHelper().Install(this->nodes.Get(i)).Get(0);
+                Ptr<LrWpanRadioEnergyModel> energyModel = CreateObject<LrWpanRadioEnergyModel>();
+                energyModel->SetEnergySource(source);
+                source->AppendDeviceEnergyModel(energyModel);
+                medium->SetEnergyModel(index, energyModel);
+                this->AddEnergyModel(i, energyModel);
+            }
+
+            if(this->IsLocal())
+            {
+                this->InstallQueues();
+            }
+        }
+
+        static BasicEnergySourceHelper BatteryHelper()
+        {
+            BasicEnergySourceHelper battery;
+            battery.Set("BasicEnergySourceInitialEnergyJ", DoubleValue(config.batteryEnergy));
+            battery.Set("BasicEnergySupplyVoltageV", DoubleValue(3.0));
+            // depleted when empty, not at the default 10 % left
+            battery.Set("BasicEnergyLowBatteryThreshold", DoubleValue(0));
+            // every radio state change updates the source already
+            battery.Set("PeriodicEnergyUpdateInterval", TimeValue(Seconds(60)));
+            return battery;
+        }
+
+        void AddEnergyModel(uint32_t index, Ptr<LrWpanRadioEnergyModel> model)
+        {
+            model->SetDepletionCallback(MakeBoundCallback(&PANNetwork::EnergyDepletedCallback, this, index));
+            this->energyModels.push_back(model);
+        }
+
+        bool IsDepleted(uint32_t index) const
+        {
+            return index < this->energyModels.size() && this->energyModels[index]->IsDepleted();
+        }
+
+        void InstallQueues()
+        {
+            // first device is coordinator, it has nothing to send
+            this->attempts.assign(this->nodes.GetN(), 0);
+            this->gtsEnd.assign(this->nodes.GetN(), Time(0));
+            this->flushEvents.assign(this->nodes.GetN(), EventId());
+            this->queues.assign(this->nodes.GetN(), Ptr<DeviceTxQueue>());
+            for(uint32_t i = 1; i < this->nodes.GetN(); i++)
+            {
+                this->queues[i] = Create<DeviceTxQueue>(
+                    config.queueCapacity,
+                    DeviceTxQueue::ParseDropPolicy(config.dropPolicy),
+                    queueStats
+                );
+            }
         }
 
         void InstallCallbacks()
         {
             NS_LOG_UNCOND("Installing callbacks...(ID: " << this->networkId << ")");
-            for(uint32_t i = 0; i < this->devices.GetN(); i++) // first device is coordinator
+            if(medium)
+            {
+                for(uint32_t i = 0; i < this->nodes.GetN(); i++)
+                {
+                    uint32_t index = this->mediumIndex[i];
+                    medium->SetMcpsDataConfirmCallback(index, MakeBoundCallback(&PANNetwork::McpsDataConfirmCallback, this, i));
+                    medium->SetMcpsDataIndicationCallback(index, MakeBoundCallback(&PANNetwork::McpsDataIndicationCallback, this));
+                    medium->SetPhyTxBeginCallback(index, MakeBoundCallback(&PANNetwork::PhyTxBeginCallback, this, i));
+                    if(i > 0)
+                    {
+                        medium->SetPhyRxBeginCallback(index, MakeCallback(&PANNetwork::PhyRxBeginCallback));
+                    }
+                }
+                return;
+            }
+
+            for(uint32_t i = 0; i < this->nodes.GetN(); i++) // first device is coordinator
             {
                 Ptr<NetDevice> device = this->devices.Get(i);
                 Ptr<LrWpanNetDevice> dev = DynamicCast<LrWpanNetDevice>(device);
 
                 // 각 콜백을 static 메서드로 설정
-                dev->GetMac()->SetMcpsDataConfirmCallback(MakeCallback(&PANNetwork::McpsDataConfirmCallback));
-                dev->GetMac()->SetMcpsDataIndicationCallback(MakeCallback(&PANNetwork::McpsDataIndicationCallback));
+                dev->GetMac()->SetMcpsDataConfirmCallback(MakeBoundCallback(&PANNetwork::McpsDataConfirmCallback, this, i));
+                dev->GetMac()->SetMcpsDataIndicationCallback(MakeBoundCallback(&PANNetwork::McpsDataIndicationCallback, this));
                 dev->GetMac()->SetMlmeBeaconNotifyIndicationCallback(MakeCallback(&PANNetwork::BeaconIndicationCallback));
+                dev->GetPhy()->TraceConnectWithoutContext("PhyTxBegin", MakeBoundCallback(&PANNetwork::PhyTxBeginCallback, this, i));
+                if(i > 0)
+                {
+                    dev->GetPhy()->TraceConnectWithoutContext("PhyRxBegin", MakeCallback(&PANNetwork::PhyRxBeginCallback));
+                }
+                if(i > 0 && gtsSchedule)
+                {
+                    dev->GetMac()->SetMlmeSyncLossIndicationCallback(MakeCallback(&PANNetwork::SyncLossCallback));
+                }
             }
         }
 
         void Start()
         {
+            if(medium)
+            {
+                return; // non-beacon PAN, nothing on air
+            }
             NS_LOG_UNCOND(Simulator::Now().As(Time::S) << "\tScheduling MLME-START.request...(ID: " << this->networkId << ")");
 
             // 각 네트워크의 가장 첫 번째 디바이스가 코디네이터임
@@ -253,52 +1104,199 @@ class PANNetwork: public Object
             params.m_logCh = 11; // 11~26
 
             Time jitter = MilliSeconds(this->GetNetworkId());
+            Time start = Seconds(0);
+
+            // beacon-enabled PAN, the first beacon at the offset of this PAN
+            if(gtsSchedule)
+            {
+                params.m_bcnOrd = gtsSchedule->GetBeaconOrder();
+                params.m_sfrmOrd = gtsSchedule->GetSuperframeOrder();
+                start = gtsSchedule->GetOffset(this->networkId);
+
+                // members track the beacons of their coordinator
+                for(uint32_t i = 1; i < this->nodes.GetN(); i++)
+                {
+                    MlmeSyncRequestParams sync;
+                    sync.m_logCh = params.m_logCh;
+                    sync.m_trackBcn = true;
+                    Simulator::ScheduleWithContext(
+                        this->networkId,
+                        Seconds(0),
+                        &LrWpanMac::MlmeSyncRequest,
+                        DynamicCast<LrWpanNetDevice>(this->GetDevices().Get(i))->GetMac(),
+                        sync
+                    );
+                }
+            }
 
             Simulator::ScheduleWithContext(
                 this->networkId,
-                Seconds(0),
+                start,
                 &LrWpanMac::MlmeStartRequest,
                 coordinatorNetDevice->GetMac(),
                 params
             );
         }
 
-        void SendData()
+        // new packet generated at end device `index`
+        void SendPacket(uint32_t index)
         {
-            // NS_LOG_UNCOND(Simulator::Now().As(Time::S) << "\tScheduling MCPS-DATA.request...(ID: " << this->networkId << ")");
+            if(this->IsDepleted(index))
+            {
+                return;
+            }
+            totalRequestedTX++;
+            this->queues[index]->Enqueue(Create<Packet>(PACKET_SIZE));
+            this->Transmit(index);
+        }
+
+        // hand the head of the queue to the MAC, one frame in the MAC at a time
+        void Transmit(uint32_t index)
+        {
+            Ptr<DeviceTxQueue> queue = this->queues[index];
+            if(!queue->IsReady() || this->IsDepleted(index))
+            {
+                return;
+            }
+
+            // gts: only inside its own GTS, with time left for the whole transaction
+            if(gtsSchedule && Simulator::Now() + GtsTransaction() > this->gtsEnd[index])
+            {
+                return;
+            }
+
+            // aggregation: wait for a full frame until the head reading is due
+            uint32_t limit = AggregateLimit();
+            Time due = queue->GetHeadEnqueueTime() + Seconds(config.aggregationDelay);
+            if(queue->GetLength() < limit && Simulator::Now() < due)
+            {
+                if(!this->flushEvents[index].IsPending())
+                {
+                    this->flushEvents[index] = Simulator::Schedule(due - Simulator::Now(), &PANNetwork::Transmit, this, index);
+                }
+                return;
+            }
+            this->flushEvents[index].Cancel();
+
+            std::vector<Ptr<Packet>> readings = queue->Dequeue(limit);
+            Ptr<Packet> msdu = config.aggregate > 1 ? AggregateHeader::Pack(readings) : readings.front();
+
+            if(medium)
+            {
+                this->attempts[index] = 0;
+                medium->McpsDataRequest(this->mediumIndex[index], this->mediumIndex[0], msdu, config.ack);
+                return;
+            }
 
-            // 각 네트워크의 가장 첫 번째 디바이스가 코디네이터임
             Ptr<LrWpanNetDevice> coordinatorNetDevice = DynamicCast<LrWpanNetDevice>(*(this->GetDevices().Begin()));
-            Mac64Address coordinatorAddr = coordinatorNetDevice->GetMac()->GetExtendedAddress();
+            Ptr<LrWpanNetDevice> lrWpanNetDevice = DynamicCast<LrWpanNetDevice>(this->GetDevices().Get(index));
 
-            // MCPS-DATA.request 파라미터
             McpsDataRequestParams params;
             params.m_srcAddrMode = EXT_ADDR;
-            params.m_dstExtAddr = coordinatorAddr;
+            params.m_dstExtAddr = coordinatorNetDevice->GetMac()->GetExtendedAddress();
             params.m_dstAddrMode = EXT_ADDR;
-            params.m_txOptions = TX_OPTION_NONE;
+            params.m_txOptions = config.ack ? TX_OPTION_ACK : TX_OPTION_NONE;
             params.m_msduHandle = 0;
 
-            Time oneBeaconTime = MilliSeconds(SLOT_LENGTH * (NODE_COUNT - 1) + SLOT_INTERVAL);
+            this->attempts[index] = 0;
+            lrWpanNetDevice->GetMac()->McpsDataRequest(params, msdu);
+        }
+
+        // receiver of end device `index` listens while idle (sleepy mode only)
+        void Wake(uint32_t index)
+        {
+            if(this->IsDepleted(index))
+            {
+                return;
+            }
+            if(medium)
+            {
+                medium->SetRxOnWhenIdle(this->mediumIndex[index], true);
+                return;
+            }
+            DynamicCast<LrWpanNetDevice>(this->GetDevices().Get(index))->GetMac()->SetRxOnWhenIdle(true);
+        }
+
+        // receiver goes off as soon as the MAC is idle
+        void Sleep(uint32_t index)
+        {
+            if(medium)
+            {
+                medium->SetRxOnWhenIdle(this->mediumIndex[index], false);
+                return;
+            }
+            DynamicCast<LrWpanNetDevice>(this->GetDevices().Get(index))->GetMac()->SetRxOnWhenIdle(false);
+        }
 
-            for(uint32_t i = 1; i < this->GetDevices().GetN(); i++) // first device is coordinator
+        // beacon of the coordinator on air, the GTS of this superframe count from here
+        void StartSuperframe()
+        {
+            uint64_t superframe = this->superframes++;
+            Time beaconInterval = gtsSchedule->GetBeaconInterval();
+
+            for(uint32_t i = 1; i < this->nodes.GetN(); i++) // first device is coordinator
             {
-                Ptr<NetDevice> netDevice = this->GetDevices().Get(i);
-                Ptr<LrWpanNetDevice> lrWpanNetDevice = DynamicCast<LrWpanNetDevice>(netDevice);
+                // receiver on around the next beacon
+                if(config.sleepy)
+                {
+                    Simulator::Schedule(beaconInterval - MilliSeconds(SLEEP_GUARD), &PANNetwork::Wake, this, i);
+                    Simulator::Schedule(beaconInterval + MilliSeconds(SLEEP_GUARD), &PANNetwork::Sleep, this, i);
+                }
+
+                Time start;
+                Time length;
+                if(!gtsSchedule->GetGts(i - 1, superframe, start, length))
+                {
+                    continue;
+                }
+                Simulator::Schedule(start, &PANNetwork::StartGts, this, i, Simulator::Now() + start + length);
+                if(config.sleepy)
+                {
+                    Simulator::Schedule(start, &PANNetwork::Wake, this, i);
+                    Simulator::Schedule(start + length + MilliSeconds(SLEEP_GUARD), &PANNetwork::Sleep, this, i);
+                }
+            }
+        }
+
+        void StartGts(uint32_t index, Time end)
+        {
+            this->gtsEnd[index] = end;
+            this->Transmit(index);
+        }
+
+        // stochastic traffic instead of the slotted loop in SendData()
+        void StartTraffic(Ptr<PanTrafficGenerator> generator)
+        {
+            this->traffic = generator;
+            this->traffic->SetBatchSize(config.batchSize);
+            this->traffic->SetArrivalCallback(MakeCallback(&PANNetwork::SendPacket, this));
+            this->traffic->Start();
+        }
 
-                Ptr<Packet> packet = Create<Packet>(PACKET_SIZE);
+        void SendData()
+        {
+            // NS_LOG_UNCOND(Simulator::Now().As(Time::S) << "\tScheduling MCPS-DATA.request...(ID: " << this->networkId << ")");
 
+            Time oneBeaconTime = MilliSeconds(SLOT_LENGTH * (config.nodeCount - 1) + SLOT_INTERVAL);
+
+            for(uint32_t i = 1; i < this->nodes.GetN(); i++) // first device is coordinator
+            {
                 Time delay = MilliSeconds(SLOT_LENGTH * (i-1));
                 // NS_LOG_UNCOND(Simulator::Now().As(Time::S) << "\tPAN " << this->GetNetworkId() << ": device " << i << " - scheduled [" << (Simulator::Now() + delay).As(Time::S) << " ~ " << (Simulator::Now() + delay + MilliSeconds(SLOT_LENGTH)).As(Time::S) << "]");
+
+                // receiver on for the slot only, before the packet of the same slot (gts: see StartSuperframe())
+                if(config.sleepy && !gtsSchedule)
+                {
+                    Simulator::Schedule(delay, &PANNetwork::Wake, this, i);
+                    Simulator::Schedule(delay + MilliSeconds(SLOT_LENGTH + SLEEP_GUARD), &PANNetwork::Sleep, this, i);
+                }
                 Simulator::ScheduleWithContext(
                     this->networkId + i,
                     delay,
-                    &LrWpanMac::McpsDataRequest,
-                    lrWpanNetDevice->GetMac(),
-                    params,
-                    packet
+                    &PANNetwork::SendPacket,
+                    this,
+                    i
                 );
-                totalRequestedTX++;
             }
 
             int noise = 0;
@@ -308,9 +1306,9 @@ class PANNetwork: public Object
             noise = x->GetInteger() % 50;
             #endif
 
-            // NS_LOG_UNCOND(Simulator::Now().As(Time::S) << "\t:: next beacon will be called at: " << (MilliSeconds((SLOT_LENGTH * (NODE_COUNT - 1) + SLOT_INTERVAL - noise) * (PAN_COUNT))+Simulator::Now()).As(Time::S) << ", PAN " << this->GetNetworkId());
+            // NS_LOG_UNCOND(Simulator::Now().As(Time::S) << "\t:: next beacon will be called at: " << (MilliSeconds((SLOT_LENGTH * (config.nodeCount - 1) + SLOT_INTERVAL - noise) * (config.panCount))+Simulator::Now()).As(Time::S) << ", PAN " << this->GetNetworkId());
             Simulator::Schedule(
-                MilliSeconds((SLOT_LENGTH * (NODE_COUNT - 1) + SLOT_INTERVAL - noise) * (PAN_COUNT)),
+                MilliSeconds((SLOT_LENGTH * (config.nodeCount - 1) + SLOT_INTERVAL - noise) * (config.panCount)),
                 MakeEvent(&PANNetwork::SendData, this)
             );
         }
@@ -318,19 +1316,105 @@ class PANNetwork: public Object
     private:
         int networkId;
         NodeContainer nodes;
-        NetDeviceContainer devices;
+        NetDeviceContainer devices;      // spectrum mode
+        std::vector<uint32_t> mediumIndex; // abstract mode, device index in the medium
 
-        Ptr<SingleModelSpectrumChannel> channel;
+        Ptr<SpectrumChannel> channel;
 
         LrWpanHelper helper;
         MobilityHelper mobility;
+
+        Ptr<PanTrafficGenerator> traffic;
+        std::vector<Ptr<DeviceTxQueue>> queues; // indexed like devices, coordinator has none
+        std::vector<uint32_t> attempts;         // transmissions of the packet currently in the MAC
+        std::vector<Time> gtsEnd;               // gts: end of the current or last GTS of each device
+        std::vector<EventId> flushEvents;       // aggregation: partial frame sent when its head reading is due
+        uint64_t superframes = 0;               // gts: beacons sent by the coordinator
+
+        std::vector<Ptr<LrWpanRadioEnergyModel>> energyModels; // indexed like devices
+        uint64_t deliveredBytes = 0;
 };
 
 int PANNetwork::totalPanId = 0;
 
+std::vector<Ptr<PANNetwork>> panNetworks;
+
+void printEnergyStats()
+{
+    const char* names[] = {"TX", "RX", "idle", "sleep"};
+    const int states = LrWpanRadioEnergyModel::RADIO_STATE_COUNT;
+    double totalEnergy = 0;
+    double totalBytes = 0;
+
+    // per PAN: time (s) and energy (J) of every state, total energy, delivered bytes;
+    // PANs of other regions have no energy models here and add zeros
+    const int columns = 2 * states + 2;
+    std::vector<double> pans(panNetworks.size() * columns, 0.0);
+    std::vector<double> depleted(1, 0.0);
+    for(auto& panNetwork : panNetworks)
+    {
+        double* pan = &pans[panNetwork->GetNetworkId() * columns];
+        for(auto& model : panNetwork->GetEnergyModels())
+        {
+            for(int s = 0; s < states; s++)
+            {
+                auto state = LrWpanRadioEnergyModel::RadioState(s);
+                pan[s] += model->GetStateTime(state).GetSeconds();
+                pan[states + s] += model->GetStateEnergy(state);
+            }
+            pan[2 * states] += model->GetTotalEnergyConsumption();
+            depleted[0] += model->IsDepleted() ? 1 : 0;
+        }
+        pan[2 * states + 1] = panNetwork->GetDeliveredBytes();
+    }
+    regions->Sum(pans);
+    regions->Sum(depleted);
+
+    NS_LOG_UNCOND("ENERGY (battery: " << config.batteryEnergy << " J per device)");
+    for(auto& panNetwork : panNetworks)
+    {
+        const double* pan = &pans[panNetwork->GetNetworkId() * columns];
+        double panEnergy = pan[2 * states];
+        double panBytes = pan[2 * states + 1];
+
+        std::ostringstream line;
+        line << "PAN " << panNetwork->GetNetworkId() << ":";
+        for(int s = 0; s < states; s++)
+        {
+            line << "\t" << names[s] << " " << pan[s] << "s/" << pan[states + s] << "J";
+        }
+        line << "\ttotal(J): " << panEnergy
+             << "\tJ/bit: " << panEnergy / std::max(panBytes * 8, 1.0);
+        NS_LOG_UNCOND(line.str());
+
+        totalEnergy += panEnergy;
+        totalBytes += panBytes;
+    }
+
+    NS_LOG_UNCOND(
+        "total energy(J): "
+        << totalEnergy
+        << "\tenergy per delivered bit(uJ): "
+        << totalEnergy * 1e6 / std::max(totalBytes * 8, 1.0)
+        << "\tdepleted devices: "
+        << depleted[0]
+        << "\nsleepy end devices: "
+        << (config.sleepy ? "on" : "off")
+        << "\tframes received by end devices: "
+        << endDeviceRxFrames
+        << "\n\n"
+    );
+}
+
 int
 main(int argc, char* argv[])
 {
+    regions = Create<RegionExchange>(&argc, &argv);
+    if(regions->GetRegion() > 0)
+    {
+        std::clog.rdbuf(nullptr); // the first region prints the totals of every region
+    }
+
     LogComponentEnableAll(LogLevel(LOG_PREFIX_TIME | LOG_PREFIX_FUNC | LOG_PREFIX_NODE));
     // LogComponentEnable("LrWpanMac", LOG_ALL);
     // LogComponentEnable("SingleModelSpectrumChannel", LOG_FUNCTION);
@@ -338,34 +1422,206 @@ main(int argc, char* argv[])
     // LogComponentEnable("LrWpanNetDevice", LOG_ALL);
     // LogComponentEnable("LrWpanCsmaCa", LOG_ALL);
 
-    std::vector<Ptr<PANNetwork>> panNetworks;
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("panCount", "PAN network count", config.panCount);
+    cmd.AddValue("nodeCount", "nodes in each PAN, coordinator included", config.nodeCount);
+    cmd.AddValue("layout", "PAN placement: line or grid", config.layout);
+    cmd.AddValue("phyMode", "spectrum (LrWpanNetDevice) or abstract (link-level model)", config.phyMode);
+    cmd.AddValue("abstractCutoff", "abstract: weakest link kept in the link budget table (dBm)", config.abstractCutoff);
+    cmd.AddValue("exactErrorModel", "abstract: error formula instead of the lookup table", config.exactErrorModel);
+    cmd.AddValue("urban", "buildings with walls and floors on a street grid", config.urban);
+    cmd.AddValue("blockSize", "urban: building footprint side (m)", config.blockSize);
+    cmd.AddValue("streetWidth", "urban: street between buildings (m)", config.streetWidth);
+    cmd.AddValue("floors", "urban: floors per building", config.floors);
+    cmd.AddValue("floorHeight", "urban: floor height (m)", config.floorHeight);
+    cmd.AddValue("rooms", "urban: rooms along each side of a floor", config.rooms);
+    cmd.AddValue("maxLoss", "urban: links with more loss are out of reach (dB)", config.maxLoss);
+    cmd.AddValue("linkCache", "urban: directory of link table files (empty: no cache)", config.linkCache);
+    cmd.AddValue("resultCache", "directory of finished runs, a run found there is replayed (empty: no cache)", config.resultCache);
+    cmd.AddValue("traffic", "traffic model: slotted, poisson, onoff or event", config.traffic);
+    cmd.AddValue("rate", "mean packets/s per end device (0: offered load of the slotted mode)", config.rate);
+    cmd.AddValue("batchSize", "arrivals generated per refill", config.batchSize);
+    cmd.AddValue("onTime", "onoff: mean ON period (s)", config.onTime);
+    cmd.AddValue("offTime", "onoff: mean OFF period (s)", config.offTime);
+    cmd.AddValue("eventRadius", "event: PANs within this distance report an event (m)", config.eventRadius);
+    cmd.AddValue("eventProbability", "event: probability that a device reports an event", config.eventProbability);
+    cmd.AddValue("eventJitter", "event: maximum reaction delay (s)", config.eventJitter);
+    cmd.AddValue("queueCapacity", "transmit queue capacity per end device (0: unbounded)", config.queueCapacity);
+    cmd.AddValue("dropPolicy", "queue drop policy: tail or head", config.dropPolicy);
+    cmd.AddValue("ack", "request MAC acknowledgments", config.ack);
+    cmd.AddValue("maxFrameRetries", "macMaxFrameRetries (ACK mode)", config.maxFrameRetries);
+    cmd.AddValue("minBE", "macMinBE of the CSMA-CA", config.minBE);
+    cmd.AddValue("maxBE", "macMaxBE of the CSMA-CA", config.maxBE);
+    cmd.AddValue("maxCsmaBackoffs", "macMaxCSMABackoffs of the CSMA-CA", config.maxCsmaBackoffs);
+    cmd.AddValue("batteryEnergy", "initial battery energy of every device (J)", config.batteryEnergy);
+    cmd.AddValue("sleepy", "end device receivers off outside their slot", config.sleepy);
+    cmd.AddValue("channelWorkers", "extra threads computing the receivers of a transmission (0: serial)", config.channelWorkers);
+    cmd.AddValue("parallelThreshold", "minimum receivers of a transmission for the parallel fan-out", config.parallelThreshold);
+    cmd.AddValue("mac", "tdma (emulated slots) or gts (beacon-enabled superframes with GTS)", config.mac);
+    cmd.AddValue("superframeOrder", "gts: superframe order (SO)", config.superframeOrder);
+    cmd.AddValue("beaconOrder", "gts: beacon order (BO), -1: smallest that separates every PAN in time", config.beaconOrder);
+    cmd.AddValue("mobility", "end device mobility: static, pedestrian or vehicle", config.mobility);
+    cmd.AddValue("mobileFraction", "share of end devices that move", config.mobileFraction);
+    cmd.AddValue("positionInterval", "time between two position updates of a moving device (s)", config.positionInterval);
+    cmd.AddValue("progress", "wall clock seconds between progress reports (0: none)", config.progress);
+    cmd.AddValue("progressFile", "file holding the last progress report (empty: stdout)", config.progressFile);
+    cmd.AddValue("aggregate", "readings per data frame at most, limited by aMaxPHYPacketSize (1: no aggregation)", config.aggregate);
+    cmd.AddValue("aggregationDelay", "longest wait of a reading for more to share its frame (s)", config.aggregationDelay);
+    cmd.Parse(argc, argv);
+
+    if(config.rate <= 0)
+    {
+        config.rate = SlottedRate();
+    }
 
-    for(int i = 0; i < PAN_COUNT; i++)
+    if(!config.resultCache.empty() && regions->GetRegion() == 0)
+    {
+        std::string description = RunDescription(argc, argv);
+        if(regions->GetRegionCount() > 1)
+        {
+            description += " regions=" + std::to_string(regions->GetRegionCount());
+        }
+        resultStore = Create<ResultStore>(config.resultCache, description);
+    }
+    // every region stops if the first one replayed
+    std::vector<double> replayed(1, resultStore && resultStore->Replay(std::clog) ? 1 : 0);
+    regions->Max(replayed);
+    if(replayed[0] > 0)
+    {
+        if(resultStore)
+        {
+            std::cerr << "result cache: " << std::hex << resultStore->GetKey() << std::dec << " replayed" << std::endl;
+        }
+        regions->Finalize();
+        return 0;
+    }
+    if(resultStore)
+    {
+        resultStore->Capture(std::clog);
+    }
+
+    // every region keeps its own status file, only the first one reports on stdout
+    if(config.progress > 0 && (!config.progressFile.empty() || regions->GetRegion() == 0))
+    {
+        progressMonitor = CreateObjectWithAttributes<ProgressMonitor>("Interval", DoubleValue(config.progress));
+        progressMonitor->InstallCountingScheduler();
+        std::string path = config.progressFile;
+        if(!path.empty() && regions->GetRegionCount() > 1)
+        {
+            path += "." + std::to_string(regions->GetRegion());
+        }
+        progressMonitor->SetStatusFile(path);
+        progressMonitor->AddField("pdr", MakeCallback(&DeliveryRatio));
+        progressMonitor->AddField("backlog", MakeCallback(&QueueBacklog));
+    }
+
+    if(config.phyMode == "abstract")
+    {
+        medium = CreateObjectWithAttributes<AbstractLrWpanMedium>("InterferenceCutoff", DoubleValue(config.abstractCutoff));
+        medium->SetCsmaParameters(config.minBE, config.maxBE, config.maxCsmaBackoffs);
+        medium->SetMaxFrameRetries(config.maxFrameRetries);
+        medium->SetExactErrorModel(config.exactErrorModel);
+    }
+    else
+    {
+        NS_ABORT_MSG_IF(config.phyMode != "spectrum", "unknown PHY mode: " << config.phyMode);
+    }
+
+    NS_ABORT_MSG_IF(config.aggregate == 0, "aggregate counts readings per frame, at least 1");
+    NS_ABORT_MSG_IF(config.aggregationDelay < 0, "aggregation delay must not be negative");
+
+    if(config.mac == "gts")
+    {
+        NS_ABORT_MSG_IF(medium, "gts needs the spectrum PHY mode, the abstract medium has no beacons");
+        uint32_t beaconOrder = config.beaconOrder >= 0
+                                   ? config.beaconOrder
+                                   : GtsSchedule::GetAutoBeaconOrder(config.superframeOrder, config.panCount);
+        gtsSchedule = Create<GtsSchedule>(beaconOrder, config.superframeOrder, config.nodeCount - 1, GtsTransaction());
+    }
+    else
+    {
+        NS_ABORT_MSG_IF(config.mac != "tdma", "unknown MAC mode: " << config.mac);
+    }
+
+    if(config.mobility != "static")
+    {
+        NS_ABORT_MSG_IF(config.mobility != "pedestrian" && config.mobility != "vehicle",
+                        "unknown mobility: " << config.mobility);
+        NS_ABORT_MSG_IF(!(config.positionInterval > 0), "position interval must be positive");
+        mobilitySampler = CreateObjectWithAttributes<MobilitySampler>("Interval", TimeValue(Seconds(config.positionInterval)));
+    }
+
+    if(regions->GetRegionCount() > 1)
+    {
+        NS_ABORT_MSG_IF(!medium, "a partitioned run needs the abstract PHY mode");
+        NS_ABORT_MSG_IF(mobilitySampler, "a partitioned run needs static devices, links are built per region");
+        NS_ABORT_MSG_IF(regions->GetRegionCount() > config.panCount, "more regions than PANs");
+        medium->SetRegionExchange(regions);
+    }
+    AssignRegions(regions->GetRegionCount());
+
+    for(uint32_t i = 0; i < config.panCount; i++)
     {
         Ptr<PANNetwork> network = CreateObject<PANNetwork>();
         panNetworks.push_back(network);
     }
 
-    Ptr<SingleModelSpectrumChannel> channel = CreateObject<SingleModelSpectrumChannel>();
-    Ptr<LogDistancePropagationLossModel> propModel =
-        CreateObject<LogDistancePropagationLossModel>();
+    // both loss and delay depend on the positions only, ParallelSpectrumChannel aborts otherwise
+    Ptr<SpectrumChannel> channel;
+    if(config.channelWorkers > 0)
+    {
+        // the urban model fills its link cache inside CalcRxPower(), not from the worker threads
+        NS_ABORT_MSG_IF(config.urban && !medium, "--urban needs --channelWorkers=0, its link cache is not thread safe");
+        channel = CreateObjectWithAttributes<ParallelSpectrumChannel>(
+            "Workers", UintegerValue(config.channelWorkers),
+            "ParallelThreshold", UintegerValue(config.parallelThreshold)
+        );
+    }
+    else
+    {
+        channel = CreateObject<SingleModelSpectrumChannel>();
+    }
+    Ptr<PropagationLossModel> propModel;
+    if(config.urban)
+    {
+        urbanModel = CreateObjectWithAttributes<UrbanBuildingPropagationLossModel>("CacheMaxLoss", DoubleValue(config.maxLoss));
+        AddCityBlocks(urbanModel);
+        propModel = urbanModel;
+    }
+    else
+    {
+        propModel = CreateObject<LogDistancePropagationLossModel>();
+    }
     Ptr<ConstantSpeedPropagationDelayModel> delayModel =
         CreateObject<ConstantSpeedPropagationDelayModel>();
 
     channel->AddPropagationLossModel(propModel);
     channel->SetPropagationDelayModel(delayModel);
+    if(medium)
+    {
+        medium->SetPropagationLossModel(propModel);
+    }
 
     for(std::vector<Ptr<PANNetwork>>::iterator panNetwork = panNetworks.begin(); panNetwork < panNetworks.end(); panNetwork++)
     {
         NS_LOG_UNCOND("Setting up PAN network...(ID: " << (*panNetwork)->GetNetworkId() << ")");
         (*panNetwork)->SetChannel(channel);
         (*panNetwork)->Install();
+        if(!(*panNetwork)->IsLocal())
+        {
+            continue;
+        }
         (*panNetwork)->Start();
         (*panNetwork)->InstallCallbacks();
 
+        if(config.traffic != "slotted")
+        {
+            continue;
+        }
+
         Simulator::Schedule(
-            // MilliSeconds((*panNetwork)->GetNetworkId() * SLOT_LENGTH * (NODE_COUNT - 1) + SLOT_INTERVAL),
-            MilliSeconds((SLOT_LENGTH * (NODE_COUNT - 1) + SLOT_INTERVAL) * (*panNetwork)->GetNetworkId()),
+            // MilliSeconds((*panNetwork)->GetNetworkId() * SLOT_LENGTH * (config.nodeCount - 1) + SLOT_INTERVAL),
+            MilliSeconds((SLOT_LENGTH * (config.nodeCount - 1) + SLOT_INTERVAL) * (*panNetwork)->GetNetworkId()),
             // Seconds(0),
             MakeEvent(
                 &PANNetwork::SendData,
@@ -374,6 +1630,121 @@ main(int argc, char* argv[])
         );
     }
 
+    // every device has its position now, links of the layout from the cache or computed once
+    if(urbanModel)
+    {
+        std::vector<Vector> positions;
+        for(uint32_t i = 0; i < NodeList::GetNNodes(); i++)
+        {
+            positions.push_back(NodeList::GetNode(i)->GetObject<MobilityModel>()->GetPosition());
+        }
+        bool cached = urbanModel->LoadOrBuildLinkTable(positions, config.linkCache);
+        NS_LOG_UNCOND(
+            "urban: "
+            << urbanModel->GetBuildingCount()
+            << " buildings, "
+            << urbanModel->GetLinkCount()
+            << " links, layout "
+            << std::hex << urbanModel->GetTopologyHash() << std::dec
+            << (cached ? " (cached)" : "")
+        );
+        if(medium)
+        {
+            // walls make the loss grow unevenly with distance, the outdoor range bounds it
+            medium->SetInterferenceRange(urbanModel->GetRange(-config.abstractCutoff));
+        }
+    }
+
+    if(medium)
+    {
+        medium->Build();
+        medium->Start();
+        std::vector<double> links(1, (double) medium->GetLinkCount()); // each region keeps the links to its devices
+        regions->Sum(links);
+        NS_LOG_UNCOND(
+            "abstract PHY: "
+            << medium->GetDeviceCount()
+            << " devices, "
+            << (uint64_t) links[0]
+            << " links, interference range(m): "
+            << medium->GetInterferenceRange()
+        );
+    }
+
+    // links of the initial layout are in place, moving devices update them from here
+    if(mobilitySampler)
+    {
+        mobilitySampler->Start();
+    }
+
+    Ptr<SharedEventProcess> events;
+    int64_t trafficStream = TRAFFIC_STREAM; // same draws whatever was created before
+
+    if(config.traffic == "event")
+    {
+        events = CreateObject<SharedEventProcess>();
+        trafficStream += events->AssignStreams(trafficStream);
+        events->SetRadius(config.eventRadius);
+        events->SetReportProbability(config.eventProbability);
+        events->SetJitter(config.eventJitter);
+        events->SetBatchSize(config.batchSize);
+    }
+
+    for(auto& panNetwork : panNetworks)
+    {
+        Ptr<PanTrafficGenerator> generator;
+
+        if(config.traffic == "poisson")
+        {
+            Ptr<PoissonTrafficGenerator> poisson = CreateObject<PoissonTrafficGenerator>();
+            poisson->SetRate(config.rate);
+            generator = poisson;
+        }
+        else if(config.traffic == "onoff")
+        {
+            Ptr<OnOffTrafficGenerator> onOff = CreateObject<OnOffTrafficGenerator>();
+            onOff->SetRate(config.rate);
+            onOff->SetOnOffTime(config.onTime, config.offTime);
+            generator = onOff;
+        }
+        else if(config.traffic == "event")
+        {
+            Ptr<EventTrafficGenerator> event = CreateObject<EventTrafficGenerator>();
+            event->SetPosition(panNetwork->GetCenter());
+            events->AddGenerator(event);
+            generator = event;
+        }
+        else
+        {
+            NS_ABORT_MSG_IF(config.traffic != "slotted", "unknown traffic model: " << config.traffic);
+            break;
+        }
+        trafficStream += generator->AssignStreams(trafficStream);
+        // every PAN, local or not: the event process draws once per device of every PAN it reaches
+        generator->SetDeviceCount(config.nodeCount - 1); // first device is coordinator
+
+        // PANs of other regions only keep the shared draws in step, they are never started
+        if(panNetwork->IsLocal())
+        {
+            panNetwork->StartTraffic(generator);
+        }
+    }
+
+    if(events)
+    {
+        // mean device rate = eventRate * coverage * probability
+        events->SetEventRate(config.rate / (events->GetCoverage() * config.eventProbability));
+        events->Start();
+    }
+
+    // backoff and reception draws of the abstract devices, after the traffic streams
+    if(medium)
+    {
+        medium->AssignStreams(trafficStream);
+    }
+
+    Time stopTime = Seconds(300);
+
     Simulator::Schedule(
         Seconds(300),
         MakeEvent(&printResult)
@@ -404,15 +1775,45 @@ main(int argc, char* argv[])
         MakeEvent(&printResult)
     );
 
-    Simulator::Schedule(
-        Seconds(30),
-        MakeEvent(&aaa)
-    );
+    if(progressMonitor)
+    {
+        progressMonitor->SetStopTime(stopTime);
+        progressMonitor->Start();
+    }
 
-    Simulator::Stop(Seconds(300));
+    auto wallStart = std::chrono::steady_clock::now();
+    Simulator::Stop(stopTime);
     Simulator::Run();
 
+    if(progressMonitor)
+    {
+        progressMonitor->Report();
+    }
+    std::vector<double> wallClock(1, std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count());
+
+    if(resultStore)
+    {
+        resultStore->Commit();
+        resultStore = nullptr;
+    }
+
+    // scaling of a partitioned run, outside of the stored result
+    std::vector<double> sent(1, (double) regions->GetSentCount());
+    regions->Max(wallClock);
+    regions->Sum(sent);
+    NS_LOG_UNCOND(
+        "REGIONS\nregions: "
+        << regions->GetRegionCount()
+        << "\twindows: "
+        << regions->GetWindowCount()
+        << "\tframes sent to other regions: "
+        << sent[0]
+        << "\twall clock(s): "
+        << wallClock[0]
+    );
+
     Simulator::Destroy();
+    regions->Finalize();
 
     return 0;
 }
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Benchmark of LrWpanChunkSuccessTable (du-wpan-error-table.h) against
+ * LrWpanErrorModel.
+ *
+ *   ./ns3 run "error-table-bench --receptions=1000000 --maxChunks=4"
+ *
+ * A reception is a du-wpan data frame split into 1..maxChunks chunks at
+ * random SINRs. LrWpanErrorModel multiplies the chunk success rates; the
+ * table adds up their logarithms and takes one exponential.
+ */
+
+#include <ns3/core-module.h>
+#include <ns3/lr-wpan-module.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "du-wpan-error-table.h"
+
+#define PACKET_SIZE 50    // payload of du-wpan.cc
+#define FRAME_OVERHEAD 17 // MAC header (short addresses) and FCS, plus PHY preamble, SFD and PHR
+
+using namespace ns3;
+
+struct Reception
+{
+    std::vector<double> sinr; // linear, per chunk
+    std::vector<uint32_t> bits;
+};
+
+volatile double sink;
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t receptions = 1000000;
+    uint32_t maxChunks = 4;
+    double minSinrDb = -5;
+    double maxSinrDb = 10;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("receptions", "receptions per measurement", receptions);
+    cmd.AddValue("maxChunks", "maximum SINR chunks of a reception", maxChunks);
+    cmd.AddValue("minSinrDb", "lowest SINR drawn (dB)", minSinrDb);
+    cmd.AddValue("maxSinrDb", "highest SINR drawn (dB)", maxSinrDb);
+    cmd.Parse(argc, argv);
+
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+
+    uint32_t frameBits = (PACKET_SIZE + FRAME_OVERHEAD) * 8;
+    std::vector<Reception> samples(receptions);
+    for(auto& reception : samples)
+    {
+        uint32_t chunks = rng->GetInteger(1, maxChunks);
+        uint32_t left = frameBits;
+        for(uint32_t c = 0; c < chunks; c++)
+        {
+            uint32_t bits = c + 1 == chunks ? left : rng->GetInteger(0, left);
+            left -= bits;
+            reception.bits.push_back(bits);
+            reception.sinr.push_back(std::pow(10.0, rng->GetValue(minSinrDb, maxSinrDb) / 10.0));
+        }
+    }
+
+    Ptr<lrwpan::LrWpanErrorModel> errorModel = CreateObject<lrwpan::LrWpanErrorModel>();
+    auto start = std::chrono::steady_clock::now();
+    Ptr<LrWpanChunkSuccessTable> table = CreateObject<LrWpanChunkSuccessTable>(); // builds the table
+    double buildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    Ptr<LrWpanChunkSuccessTable> exact = CreateObjectWithAttributes<LrWpanChunkSuccessTable>("Exact", BooleanValue(true));
+
+    std::vector<double> reference(receptions);
+    start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < receptions; i++)
+    {
+        double p = 1;
+        for(uint32_t c = 0; c < samples[i].bits.size(); c++)
+        {
+            p *= errorModel->GetChunkSuccessRate(samples[i].sinr[c], samples[i].bits[c]);
+        }
+        reference[i] = p;
+    }
+    double modelTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    auto run = [&](Ptr<LrWpanChunkSuccessTable> t, double& maxDiff) {
+        maxDiff = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i < receptions; i++)
+        {
+            double logSuccess = 0;
+            for(uint32_t c = 0; c < samples[i].bits.size(); c++)
+            {
+                logSuccess += t->GetLogChunkSuccessRate(samples[i].sinr[c], samples[i].bits[c]);
+            }
+            double p = std::exp(logSuccess);
+            sink = p;
+            maxDiff = std::max(maxDiff, std::abs(p - reference[i]));
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    };
+
+    double exactDiff;
+    double tableDiff;
+    double exactTime = run(exact, exactDiff);
+    double tableTime = run(table, tableDiff);
+
+    std::cout << "frame: " << frameBits << " bits, 1.." << maxChunks << " chunks, SINR "
+              << minSinrDb << ".." << maxSinrDb << " dB, " << receptions << " receptions\n"
+              << "table: " << table->GetSize() << " points, built in " << buildTime << " ms"
+              << ", interpolation error " << table->GetMaxError()
+              << ", success rate bound " << table->GetSuccessRateErrorBound() << "\n\n"
+              << "LrWpanErrorModel : " << modelTime / receptions << " ns/reception\n"
+              << "exact            : " << exactTime / receptions << " ns/reception"
+              << "  speedup " << modelTime / exactTime << "x  max diff " << exactDiff << "\n"
+              << "table            : " << tableTime / receptions << " ns/reception"
+              << "  speedup " << modelTime / tableTime << "x  max diff " << tableDiff << "\n";
+
+    return 0;
+}
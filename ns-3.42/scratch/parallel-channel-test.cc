@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Equivalence check of ParallelSpectrumChannel (du-wpan-channel.h) against
+ * SingleModelSpectrumChannel.
+ *
+ *   ./ns3 run "parallel-channel-test --devices=500 --transmissions=2000 --workers=4"
+ *
+ * Every device is a recording PHY at a random position on a square; random
+ * devices transmit on a random LR-WPAN channel at a random power. Both channels
+ * see the same transmissions, every transmission goes through the parallel
+ * fan-out (ParallelThreshold 1). Both channels have a transmit filter that
+ * drops every third device. Every receiver must see the same StartRx() calls,
+ * at the same times, with bit-identical PSDs, and the filtered devices none.
+ * Exits with 1 otherwise.
+ */
+
+#include <ns3/core-module.h>
+#include <ns3/lr-wpan-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/propagation-module.h>
+#include <ns3/spectrum-module.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "du-wpan-channel.h"
+
+using namespace ns3;
+
+struct Reception
+{
+    int64_t time; // ns
+    std::vector<double> psd;
+};
+
+// receiver that keeps every signal reaching it
+class RecordingPhy: public SpectrumPhy
+{
+    public:
+        RecordingPhy(Ptr<const SpectrumModel> model, Ptr<MobilityModel> mobility, bool filtered)
+            : model(model),
+              mobility(mobility),
+              filtered(filtered)
+        {
+        }
+
+        bool IsFiltered() const
+        {
+            return this->filtered;
+        }
+
+        void SetDevice(Ptr<NetDevice> d) override {}
+        Ptr<NetDevice> GetDevice() const override { return nullptr; }
+        void SetMobility(Ptr<MobilityModel> m) override { this->mobility = m; }
+        Ptr<MobilityModel> GetMobility() const override { return this->mobility; }
+        void SetChannel(Ptr<SpectrumChannel> c) override {}
+        Ptr<const SpectrumModel> GetRxSpectrumModel() const override { return this->model; }
+        Ptr<Object> GetAntenna() const override { return nullptr; }
+
+        void StartRx(Ptr<SpectrumSignalParameters> params) override
+        {
+            Reception reception;
+            reception.time = Simulator::Now().GetNanoSeconds();
+            reception.psd.assign(params->psd->ConstValuesBegin(), params->psd->ConstValuesEnd());
+            this->receptions.push_back(reception);
+        }
+
+        const std::vector<Reception>& GetReceptions() const
+        {
+            return this->receptions;
+        }
+
+    private:
+        Ptr<const SpectrumModel> model;
+        Ptr<MobilityModel> mobility;
+        bool filtered;
+        std::vector<Reception> receptions;
+};
+
+// drops the recording PHYs marked as filtered
+class RecordingPhyFilter: public SpectrumTransmitFilter
+{
+    private:
+        bool DoFilter(Ptr<const SpectrumSignalParameters> params, Ptr<const SpectrumPhy> receiverPhy) override
+        {
+            Ptr<const RecordingPhy> phy = DynamicCast<const RecordingPhy>(receiverPhy);
+            return phy && phy->IsFiltered();
+        }
+
+        int64_t DoAssignStreams(int64_t stream) override
+        {
+            return 0;
+        }
+};
+
+struct Transmission
+{
+    uint32_t device;
+    Ptr<SpectrumValue> psd;
+};
+
+struct Result
+{
+    double seconds;
+    std::vector<std::vector<Reception>> receptions; // per device
+};
+
+Result
+Run(Ptr<SpectrumChannel> channel, Ptr<const SpectrumModel> model, const std::vector<Ptr<MobilityModel>>& mobilities, const std::vector<Transmission>& transmissions, double maxLoss)
+{
+    channel->SetAttribute("MaxLossDb", DoubleValue(maxLoss));
+    channel->AddPropagationLossModel(CreateObject<LogDistancePropagationLossModel>());
+    channel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+    channel->AddSpectrumTransmitFilter(CreateObject<RecordingPhyFilter>());
+
+    std::vector<Ptr<RecordingPhy>> phys;
+    for(uint32_t i = 0; i < mobilities.size(); i++)
+    {
+        Ptr<RecordingPhy> phy = CreateObject<RecordingPhy>(model, mobilities[i], i % 3 == 2);
+        channel->AddRx(phy);
+        phys.push_back(phy);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < transmissions.size(); i++)
+    {
+        Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters>();
+        params->psd = transmissions[i].psd;
+        params->duration = MicroSeconds(4256); // 133 bytes
+        params->txPhy = phys[transmissions[i].device];
+        Simulator::Schedule(MicroSeconds(100) * (int64_t) i, &SpectrumChannel::StartTx, channel, params);
+    }
+    Simulator::Run();
+    auto stop = std::chrono::steady_clock::now();
+
+    Result result;
+    result.seconds = std::chrono::duration<double>(stop - start).count();
+    for(auto& phy : phys)
+    {
+        result.receptions.push_back(phy->GetReceptions());
+    }
+    Simulator::Destroy();
+    return result;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t devices = 500;
+    uint32_t transmissions = 2000;
+    uint32_t workers = 4;
+    double side = 100;     // m
+    double maxLoss = 1e9;  // dB, MaxLossDb of both channels
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("devices", "LR-WPAN devices", devices);
+    cmd.AddValue("transmissions", "transmissions by random devices", transmissions);
+    cmd.AddValue("workers", "extra threads of the parallel fan-out", workers);
+    cmd.AddValue("side", "side of the square the devices are on (m)", side);
+    cmd.AddValue("maxLoss", "MaxLossDb of both channels, receivers beyond it get nothing", maxLoss);
+    cmd.Parse(argc, argv);
+    NS_ABORT_MSG_IF(devices < 2 || workers == 0, "needs two devices and one worker");
+
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+
+    std::vector<Ptr<MobilityModel>> mobilities;
+    for(uint32_t i = 0; i < devices; i++)
+    {
+        Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel>();
+        mobility->SetPosition(Vector(rng->GetValue(0, side), rng->GetValue(0, side), 1));
+        mobilities.push_back(mobility);
+    }
+
+    lrwpan::LrWpanSpectrumValueHelper helper;
+    Ptr<const SpectrumModel> model = helper.CreateTxPowerSpectralDensity(0, 11)->GetSpectrumModel();
+    std::vector<Transmission> schedule;
+    for(uint32_t i = 0; i < transmissions; i++)
+    {
+        Transmission transmission;
+        transmission.device = rng->GetInteger(0, devices - 1);
+        transmission.psd = helper.CreateTxPowerSpectralDensity(rng->GetValue(-10, 5), rng->GetInteger(11, 26));
+        schedule.push_back(transmission);
+    }
+
+    Result serial = Run(CreateObject<SingleModelSpectrumChannel>(), model, mobilities, schedule, maxLoss);
+    Ptr<ParallelSpectrumChannel> parallelChannel = CreateObjectWithAttributes<ParallelSpectrumChannel>(
+        "Workers", UintegerValue(workers),
+        "ParallelThreshold", UintegerValue(1)
+    );
+    Result parallel = Run(parallelChannel, model, mobilities, schedule, maxLoss);
+
+    uint64_t receptions = 0;
+    uint32_t mismatches = 0; // receivers whose receptions differ
+    uint32_t unfiltered = 0; // filtered receivers that got a signal anyway
+    for(uint32_t i = 0; i < devices; i++)
+    {
+        const std::vector<Reception>& a = serial.receptions[i];
+        const std::vector<Reception>& b = parallel.receptions[i];
+        receptions += a.size();
+        unfiltered += i % 3 == 2 && (!a.empty() || !b.empty());
+        bool same = a.size() == b.size();
+        for(size_t k = 0; same && k < a.size(); k++)
+        {
+            same = a[k].time == b[k].time && a[k].psd == b[k].psd; // exact, no tolerance
+        }
+        mismatches += !same;
+    }
+
+    std::cout << "devices: " << devices << ", transmissions: " << transmissions << ", workers: " << workers
+              << ", receptions: " << receptions << "\n"
+              << std::setw(12) << "channel" << std::setw(14) << "us/tx" << std::setw(10) << "speedup" << "\n";
+    auto row = [&](std::string name, const Result& result) {
+        std::cout << std::setw(12) << name << std::setw(14) << std::fixed << std::setprecision(2)
+                  << result.seconds * 1e6 / transmissions << std::setw(9)
+                  << serial.seconds / result.seconds << "x" << std::defaultfloat << "\n";
+    };
+    row("single", serial);
+    row("parallel", parallel);
+    std::cout << "receivers with different receptions: " << mismatches << (mismatches ? "  FAILED" : "") << "\n"
+              << "filtered receivers with receptions: " << unfiltered << (unfiltered ? "  FAILED" : "") << std::endl;
+
+    return mismatches || unfiltered ? 1 : 0;
+}
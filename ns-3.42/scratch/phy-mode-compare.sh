@@ -0,0 +1,53 @@
+#!/bin/sh
+#
+# Copyright (c) 2024 Gyeongsang National University, South Korea.
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License version 2 as
+# published by the Free Software Foundation;
+#
+# Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+#
+# PDR of --phyMode=abstract against --phyMode=spectrum on small topologies.
+#
+#   scratch/phy-mode-compare.sh [runs] [extra du-wpan options]
+#   scratch/phy-mode-compare.sh 10 --traffic=poisson --rate=20
+#
+# Every topology is run with RngRun 1..runs in both modes. One line per
+# topology: mean PDR ("ratio" of du-wpan) and 95% confidence half-width of
+# each mode, their difference and whether it is inside the combined interval.
+
+runs=${1:-5}
+[ $# -gt 0 ] && shift
+extra="$*"
+
+cd "$(dirname "$0")/.." || exit 1
+
+topologies="--panCount=1 --panCount=3 --panCount=5 --panCount=4,--layout=grid --panCount=9,--layout=grid"
+
+printf '%-28s %17s %18s %10s %s\n' topology spectrum abstract diff match
+for topology in $topologies; do
+    options=$(echo "$topology" | tr ',' ' ')
+    for mode in spectrum abstract; do
+        run=1
+        while [ "$run" -le "$runs" ]; do
+            ./ns3 run --no-build "du-wpan --phyMode=$mode $options --RngRun=$run --progress=0 $extra" 2>&1 \
+                | sed -n 's/.*ratio: \([0-9.e+-]*\)%.*/\1/p' | tail -n 1 | sed "s/^/$mode /"
+            run=$((run + 1))
+        done
+    done | awk -v topology="$options" '
+        { n[$1]++; sum[$1] += $2; squares[$1] += $2 * $2 }
+        function mean(m) { return n[m] ? sum[m] / n[m] : 0 }
+        function half(m,   v) {
+            if(n[m] < 2) return 0
+            v = (squares[m] - n[m] * mean(m) ^ 2) / (n[m] - 1)
+            return 1.96 * sqrt(v > 0 ? v : 0) / sqrt(n[m])
+        }
+        END {
+            d = mean("abstract") - mean("spectrum")
+            h = sqrt(half("abstract") ^ 2 + half("spectrum") ^ 2)
+            printf "%-28s %10.2f +-%5.2f %10.2f +-%5.2f %+10.2f %s\n", topology,
+                mean("spectrum"), half("spectrum"), mean("abstract"), half("abstract"), d,
+                (d <= h && -d <= h) ? "yes" : "NO"
+        }'
+done
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Microbenchmark of the PSD scaling kernel in du-wpan-spectrum-kernels.h
+ * against SpectrumValue::operator*= of ns-3.
+ *
+ *   ./ns3 run "spectrum-kernels-bench --iterations=200000"
+ *
+ * Band vectors:
+ *   lrwpan   model of LrWpanSpectrumValueHelper (channel 11)
+ *   ble      1 MHz bands over the 2.4 GHz ISM band (84)
+ *   wifi20   78.125 kHz bands over 20 MHz + 2 x 2 MHz guard (308)
+ *   wifi80   78.125 kHz bands over 80 MHz + 2 x 2 MHz guard (1076)
+ *
+ * Every row is ns per operation; "diff" is the largest deviation from the
+ * ns-3 result, which must be 0.
+ */
+
+#include <ns3/core-module.h>
+#include <ns3/lr-wpan-module.h>
+#include <ns3/spectrum-module.h>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "du-wpan-spectrum-kernels.h"
+
+using namespace ns3;
+
+Ptr<SpectrumModel>
+UniformModel(double startHz, double bandHz, uint32_t bands)
+{
+    std::vector<double> centers;
+    for(uint32_t i = 0; i < bands; i++)
+    {
+        centers.push_back(startHz + (i + 0.5) * bandHz);
+    }
+    return Create<SpectrumModel>(centers);
+}
+
+void
+Fill(Ptr<SpectrumValue> value, Ptr<UniformRandomVariable> rng)
+{
+    for(SpectrumValue::Iterator it = value->ValuesBegin(); it != value->ValuesEnd(); it++)
+    {
+        *it = rng->GetValue(1e-15, 1e-9); // W/Hz, received PSD range
+    }
+}
+
+double
+MaxDiff(const SpectrumValue& a, const SpectrumValue& b)
+{
+    double diff = 0;
+    for(uint32_t i = 0; i < a.GetValuesN(); i++)
+    {
+        diff = std::max(diff, std::abs(a[i] - b[i]));
+    }
+    return diff;
+}
+
+// ns per call of fn, each call runs `pairs` operations
+template <typename F>
+double
+Measure(uint32_t iterations, uint32_t pairs, F fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < iterations; i++)
+    {
+        fn();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / ((double) iterations * pairs);
+}
+
+void
+RunBands(std::string name, Ptr<const SpectrumModel> model, uint32_t iterations, Ptr<UniformRandomVariable> rng)
+{
+    Ptr<SpectrumValue> a = Create<SpectrumValue>(model);
+    Fill(a, rng);
+    double k = 1.0000001;
+
+    std::vector<SpectrumKernels::Isa> isas = {SpectrumKernels::ISA_SCALAR};
+    if(SpectrumKernels::GetBestIsa() >= SpectrumKernels::ISA_SSE2)
+    {
+        isas.push_back(SpectrumKernels::ISA_SSE2);
+    }
+    if(SpectrumKernels::GetBestIsa() >= SpectrumKernels::ISA_AVX2)
+    {
+        isas.push_back(SpectrumKernels::ISA_AVX2);
+    }
+
+    std::cout << "\n" << name << " (" << a->GetValuesN() << " bands)\n"
+              << std::setw(10) << "op" << std::setw(10) << "impl" << std::setw(12) << "ns/op"
+              << std::setw(10) << "speedup" << std::setw(14) << "diff" << "\n";
+
+    auto row = [](std::string op, std::string impl, double ns, double base, double diff) {
+        std::cout << std::setw(10) << op << std::setw(10) << impl << std::setw(12) << std::fixed
+                  << std::setprecision(1) << ns << std::setw(9) << std::setprecision(2) << base / ns << "x"
+                  << std::setw(14) << std::scientific << std::setprecision(2) << diff << std::defaultfloat << "\n";
+    };
+
+    // scale: psd *= k, then *= 1/k so the values stay in range
+    {
+        SpectrumValue work = *a;
+        double base = Measure(iterations, 2, [&] { work *= k; work *= 1 / k; });
+        SpectrumValue reference = *a;
+        reference *= k;
+        row("scale", "ns-3", base, base, 0);
+        for(auto isa : isas)
+        {
+            const SpectrumKernels::Table& t = SpectrumKernels::GetTable(isa);
+            double* x = &*work.ValuesBegin();
+            uint32_t n = work.GetValuesN();
+            double ns = Measure(iterations, 2, [&] { t.scale(x, n, k); t.scale(x, n, 1 / k); });
+            SpectrumValue check = *a;
+            t.scale(&*check.ValuesBegin(), n, k);
+            row("scale", SpectrumKernels::GetIsaName(isa), ns, base, MaxDiff(check, reference));
+        }
+    }
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t iterations = 100000;
+    uint32_t bands = 0;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("iterations", "calls per measurement", iterations);
+    cmd.AddValue("bands", "also run a uniform model with this many bands (0: off)", bands);
+    cmd.Parse(argc, argv);
+
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+
+    std::cout << "best instruction set: " << SpectrumKernels::GetIsaName(SpectrumKernels::GetBestIsa()) << "\n";
+
+    lrwpan::LrWpanSpectrumValueHelper lrwpanHelper;
+    RunBands("lrwpan", lrwpanHelper.CreateTxPowerSpectralDensity(0, 11)->GetSpectrumModel(), iterations, rng);
+    RunBands("ble", UniformModel(2400e6, 1e6, 84), iterations, rng);
+    RunBands("wifi20", UniformModel(2412e6 - 12e6, 78125, 308), iterations, rng);
+    RunBands("wifi80", UniformModel(5210e6 - 42e6, 78125, 1076), iterations, rng);
+    if(bands > 0)
+    {
+        RunBands("custom", UniformModel(2400e6, 1e6, bands), iterations, rng);
+    }
+
+    return 0;
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2024 Gyeongsang National University, South Korea.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author:  Jo Seoung Hyeon <gmelan@gnu.ac.kr>
+ */
+
+/*
+ * Check of the traffic generators of du-wpan-traffic.h with the du-wpan
+ * defaults (10 nodes per PAN, 3 PANs worth of slotted load, batch of 64).
+ *
+ *   ./ns3 run "traffic-test --pans=1000 --time=120"
+ *
+ * Every PAN must see arrivals, and the mean rate per device must be close to
+ * the offered rate. Event traffic is also run as du-wpan does with two regions:
+ * every generator is created and given its device count, only the PANs of one
+ * region are started; they must see the same arrivals as in the single region
+ * run. Exits with 1 otherwise.
+ */
+
+#include <ns3/core-module.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "du-wpan-traffic.h"
+
+using namespace ns3;
+
+void
+Count(std::vector<uint64_t>* arrivals, uint32_t pan, uint32_t device)
+{
+    (*arrivals)[pan]++;
+}
+
+// silent PANs of one traffic model, the mean device rate in `measured`
+uint32_t
+Run(std::string model, uint32_t pans, uint32_t devices, double rate, double time, double& measured)
+{
+    std::vector<uint64_t> arrivals(pans, 0);
+    std::vector<Ptr<PanTrafficGenerator>> generators;
+    int64_t stream = 0;
+
+    for(uint32_t pan = 0; pan < pans; pan++)
+    {
+        Ptr<PanTrafficGenerator> generator;
+        if(model == "poisson")
+        {
+            Ptr<PoissonTrafficGenerator> poisson = CreateObject<PoissonTrafficGenerator>();
+            poisson->SetRate(rate);
+            generator = poisson;
+        }
+        else
+        {
+            Ptr<OnOffTrafficGenerator> onOff = CreateObject<OnOffTrafficGenerator>();
+            onOff->SetRate(rate);
+            onOff->SetOnOffTime(1, 9);
+            generator = onOff;
+        }
+        stream += generator->AssignStreams(stream);
+        generator->SetDeviceCount(devices);
+        generator->SetBatchSize(64);
+        generator->SetArrivalCallback(MakeBoundCallback(&Count, &arrivals, pan));
+        generator->Start();
+        generators.push_back(generator);
+    }
+
+    Simulator::Stop(Seconds(time));
+    Simulator::Run();
+
+    uint32_t silent = 0;
+    uint64_t total = 0;
+    for(uint64_t count : arrivals)
+    {
+        silent += count == 0;
+        total += count;
+    }
+    measured = total / (time * pans * devices);
+
+    for(auto& generator : generators)
+    {
+        generator->Stop();
+    }
+    Simulator::Destroy();
+    return silent;
+}
+
+// arrivals per PAN of event traffic on a row of PANs, only PANs with `local` set are started
+std::vector<uint64_t>
+RunEvent(uint32_t pans, uint32_t devices, double rate, double time, const std::vector<bool>& local)
+{
+    std::vector<uint64_t> arrivals(pans, 0);
+    std::vector<Ptr<PanTrafficGenerator>> generators;
+    int64_t stream = 0;
+
+    Ptr<SharedEventProcess> events = CreateObject<SharedEventProcess>();
+    stream += events->AssignStreams(stream);
+    events->SetRadius(30);
+    events->SetReportProbability(0.5);
+    events->SetBatchSize(64);
+
+    for(uint32_t pan = 0; pan < pans; pan++)
+    {
+        Ptr<EventTrafficGenerator> generator = CreateObject<EventTrafficGenerator>();
+        generator->SetPosition(Vector(pan * 40.0, 0, 0));
+        events->AddGenerator(generator);
+        stream += generator->AssignStreams(stream);
+        generator->SetDeviceCount(devices);
+        if(local[pan])
+        {
+            generator->SetBatchSize(64);
+            generator->SetArrivalCallback(MakeBoundCallback(&Count, &arrivals, pan));
+            generator->Start();
+        }
+        generators.push_back(generator);
+    }
+    events->SetEventRate(rate / (events->GetCoverage() * 0.5));
+    events->Start();
+
+    Simulator::Stop(Seconds(time));
+    Simulator::Run();
+    for(auto& generator : generators)
+    {
+        generator->Stop();
+    }
+    Simulator::Destroy();
+    return arrivals;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t pans = 1000;
+    uint32_t nodeCount = 10;
+    double time = 120; // s
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("pans", "PANs with one generator each", pans);
+    cmd.AddValue("nodeCount", "nodes per PAN, coordinator included", nodeCount);
+    cmd.AddValue("time", "simulated time (s)", time);
+    cmd.Parse(argc, argv);
+
+    // same offered load as the slotted loop of du-wpan with 3 PANs
+    uint32_t devices = nodeCount - 1;
+    double rate = 1000.0 / ((nodeCount - 1 + 1) * 3);
+
+    bool failed = false;
+    for(std::string model : {"poisson", "onoff"})
+    {
+        double measured = 0;
+        uint32_t silent = Run(model, pans, devices, rate, time, measured);
+        // on/off: one device has (1 + 9) s cycles, the mean converges slowly
+        bool rateOk = std::abs(measured - rate) < rate * 0.1;
+        std::cout << model << ": silent PANs " << silent << "/" << pans
+                  << ", rate per device " << measured << " (offered " << rate << ")"
+                  << (silent == 0 && rateOk ? "" : "  FAILED") << std::endl;
+        failed |= silent > 0 || !rateOk;
+    }
+
+    // region 1 of two: the right half of the row, as AssignRegions() splits it
+    uint32_t eventPans = std::min<uint32_t>(pans, 100);
+    std::vector<bool> all(eventPans, true);
+    std::vector<bool> right(eventPans, false);
+    std::fill(right.begin() + eventPans / 2, right.end(), true);
+    std::vector<uint64_t> one = RunEvent(eventPans, devices, rate, time, all);
+    std::vector<uint64_t> two = RunEvent(eventPans, devices, rate, time, right);
+    uint32_t different = 0;
+    uint64_t total = 0;
+    for(uint32_t pan = eventPans / 2; pan < eventPans; pan++)
+    {
+        different += one[pan] != two[pan];
+        total += one[pan];
+    }
+    std::cout << "event: PANs of region 1 with other arrivals than in one region " << different
+              << "/" << eventPans - eventPans / 2 << " (" << total << " arrivals)"
+              << (different == 0 && total > 0 ? "" : "  FAILED") << std::endl;
+    failed |= different > 0 || total == 0;
+
+    return failed ? 1 : 0;
+}